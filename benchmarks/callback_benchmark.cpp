@@ -0,0 +1,115 @@
+// SoundIO - Callback overhead benchmark
+// Copyright (c) 2025 - (real)Coloride
+// https://github.com/realcoloride/soundio
+//
+// Measures the per-callback cost of pushing a block in with submitPCM() and pulling it out
+// with receivePCM() through chains of pass-through nodes (MIT), pipeline leases, ring copies
+// and hooks included. Chain lengths are run interleaved, in a rotating order, over several
+// rounds and the median is kept, so no length benefits from running last on a warm machine.
+// The per-hop cost is the slope between the shortest and the longest chain. The cost of one
+// pipeline lease (PipelineScope, taken on every pull and push) is measured on its own.
+// Powered by miniaudio (https:://miniaud.io)
+
+#include <core/AudioFormat.h>
+#include <input/AudioStreamInput.h>
+#include <output/AudioStreamOutput.h>
+#include <mixer/AudioMixer.h>
+#include <chrono>
+#include <iostream>
+
+// benchmark parameters
+const size_t chainLengths[] = { 1, 2, 4, 8 };
+const ma_uint32 blockFrames = 64;
+const ma_uint64 callbacks = 50000;
+const int rounds = 7;
+const AudioFormat format = AudioFormat::Stereo48kF32();
+
+struct Chain {
+    AudioStreamInput source{ format };
+    std::vector<std::unique_ptr<AudioMixer>> nodes;
+    AudioStreamOutput sink{ format };
+
+    explicit Chain(size_t length) {
+        AudioInput* previous = &source;
+        for (size_t i = 0; i < length; i++) {
+            nodes.push_back(std::make_unique<AudioMixer>(format, blockFrames));
+            previous->subscribe(nodes.back().get());
+            previous = nodes.back().get();
+        }
+        previous->subscribe(&sink);
+    }
+};
+
+// Exposes the lease every pull and push takes
+struct LeaseProbe : AudioStreamInput {
+    LeaseProbe() : AudioStreamInput(format) {}
+
+    size_t lease() {
+        PipelineScope scope(this);
+        return current().inputRingFrames;
+    }
+};
+
+static double runChain(Chain& chain) {
+    std::vector<float> input(blockFrames * format.channels, 0.25f);
+    std::vector<float> output(blockFrames * format.channels);
+
+    auto start = std::chrono::steady_clock::now();
+    for (ma_uint64 i = 0; i < callbacks; i++) {
+        chain.source.submitPCM(input.data(), blockFrames);
+        chain.sink.receivePCM(output.data(), blockFrames);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return seconds * 1e9 / callbacks;
+}
+
+static double runLeases(LeaseProbe& probe) {
+    volatile size_t sink = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (ma_uint64 i = 0; i < callbacks; i++) sink = sink + probe.lease();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return seconds * 1e9 / callbacks;
+}
+
+static double median(std::vector<double> samples) {
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+int main() {
+    constexpr size_t lengthCount = sizeof(chainLengths) / sizeof(chainLengths[0]);
+
+    std::cout << "[SoundIO] callback overhead benchmark" << std::endl;
+    std::cout << "block=" << blockFrames << ", " << callbacks << " callbacks x " << rounds << " rounds, median" << std::endl;
+
+    std::vector<std::unique_ptr<Chain>> chains;
+    for (size_t length : chainLengths) {
+        chains.push_back(std::make_unique<Chain>(length));
+        runChain(*chains.back()); // warm up
+    }
+    LeaseProbe probe;
+    runLeases(probe);
+
+    std::vector<std::vector<double>> chainSamples(lengthCount);
+    std::vector<double> leaseSamples;
+    for (int round = 0; round < rounds; round++) {
+        for (size_t i = 0; i < lengthCount; i++) {
+            const size_t index = (i + round) % lengthCount;
+            chainSamples[index].push_back(runChain(*chains[index]));
+        }
+        leaseSamples.push_back(runLeases(probe));
+    }
+
+    std::vector<double> medians;
+    for (size_t i = 0; i < lengthCount; i++) {
+        medians.push_back(median(chainSamples[i]));
+        std::cout << std::setw(2) << chainLengths[i] << " nodes: " << std::fixed << std::setprecision(1)
+            << std::setw(8) << medians.back() << " ns/callback" << std::endl;
+    }
+
+    const double perHop = (medians.back() - medians.front()) / (chainLengths[lengthCount - 1] - chainLengths[0]);
+    std::cout << "per hop:  " << std::setw(8) << perHop << " ns" << std::endl;
+    std::cout << "lease:    " << std::setw(8) << median(leaseSamples) << " ns (PipelineScope, taken per pull and push)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,73 @@
+// SoundIO - Combiner benchmark
+// Copyright (c) 2025 - (real)Coloride
+// https://github.com/realcoloride/soundio
+//
+// Measures AudioCombiner's summation kernels (MIT): mixed output frames/sec
+// versus input count, vectorized kernels against the scalar fallback.
+// Powered by miniaudio (https:://miniaud.io)
+
+#include <utils/simdmix.h>
+#include <chrono>
+#include <iostream>
+
+// benchmark parameters
+const ma_uint32 channels = 2;
+const ma_uint32 blockFrames = 256;
+const double secondsPerRun = 0.25;
+
+using AccumulateKernel = void(*)(float*, const float*, float, size_t);
+using ClipKernel = void(*)(float*, size_t);
+
+// returns mixed output frames per second
+static double runBenchmark(size_t inputCount, AccumulateKernel accumulate, ClipKernel clip) {
+    const size_t samples = (size_t)blockFrames * channels;
+
+    std::vector<std::vector<float>> inputs(inputCount, std::vector<float>(samples));
+    for (size_t i = 0; i < inputCount; i++)
+        for (size_t j = 0; j < samples; j++)
+            inputs[i][j] = (float)((i * 31 + j) % 200) / 200.0f - 0.5f;
+
+    std::vector<float> mix(samples);
+    const float gain = 1.0f / (float)inputCount;
+
+    ma_uint64 blocks = 0;
+    auto start = std::chrono::steady_clock::now();
+    double elapsed = 0.0;
+
+    while (elapsed < secondsPerRun) {
+        for (int repeat = 0; repeat < 16; repeat++) {
+            std::fill(mix.begin(), mix.end(), 0.0f);
+            for (auto& input : inputs)
+                accumulate(mix.data(), input.data(), gain, samples);
+            clip(mix.data(), samples);
+        }
+
+        blocks += 16;
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // keeps the result alive
+    volatile float sink = mix[blocks % samples];
+    (void)sink;
+
+    return (double)(blocks * blockFrames) / elapsed;
+}
+
+int main() {
+    std::cout << "[SoundIO] combiner benchmark" << std::endl;
+    std::cout << "kernel=" << getMixKernelName() << " channels=" << channels << " block=" << blockFrames << std::endl;
+    std::cout << "inputs\tscalar frames/s\tsimd frames/s\tsimd input-frames/s\tspeedup" << std::endl;
+
+    for (size_t inputCount = 1; inputCount <= 512; inputCount *= 2) {
+        double scalar = runBenchmark(inputCount, &mixAccumulateF32Scalar, &softClipF32Scalar);
+        double simd = runBenchmark(inputCount, &mixAccumulateF32, &softClipF32);
+
+        std::cout << inputCount << "\t"
+            << (ma_uint64)scalar << "\t"
+            << (ma_uint64)simd << "\t"
+            << (ma_uint64)(simd * inputCount) << "\t"
+            << simd / scalar << "x" << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,90 @@
+// SoundIO - Format conversion benchmark
+// Copyright (c) 2025 - (real)Coloride
+// https://github.com/realcoloride/soundio
+//
+// Measures AudioConverter's fast path (MIT): output samples/sec per kernel,
+// against ma_data_converter doing the same conversion.
+// Powered by miniaudio (https:://miniaud.io)
+
+#include <core/AudioConverter.h>
+#include <chrono>
+#include <iostream>
+
+// benchmark parameters
+const ma_uint32 sampleRate = 48000;
+const ma_uint32 blockFrames = 512;
+const double secondsPerRun = 0.25;
+
+struct Case {
+    const char* name;
+    AudioFormat from;
+    AudioFormat to;
+};
+
+static double runFast(const Case& test, std::vector<ma_uint8>& in, std::vector<ma_uint8>& out) {
+    AudioConverter converter;
+    converter.init(test.from, test.to);
+
+    ma_uint64 frames = 0;
+    auto start = std::chrono::steady_clock::now();
+    double seconds = 0.0;
+    do {
+        for (int i = 0; i < 64; i++) {
+            ma_uint64 inF = blockFrames, outF = blockFrames;
+            converter.process(in.data(), &inF, out.data(), &outF);
+            frames += outF;
+        }
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    } while (seconds < secondsPerRun);
+
+    return frames * test.to.channels / seconds;
+}
+
+static double runMiniaudio(const Case& test, std::vector<ma_uint8>& in, std::vector<ma_uint8>& out) {
+    ma_data_converter converter;
+    ma_data_converter_config config = ma_data_converter_config_init(
+        test.from.format, test.to.format, test.from.channels, test.to.channels, test.from.sampleRate, test.to.sampleRate);
+    if (ma_data_converter_init(&config, nullptr, &converter) != MA_SUCCESS) return 0.0;
+
+    ma_uint64 frames = 0;
+    auto start = std::chrono::steady_clock::now();
+    double seconds = 0.0;
+    do {
+        for (int i = 0; i < 64; i++) {
+            ma_uint64 inF = blockFrames, outF = blockFrames;
+            ma_data_converter_process_pcm_frames(&converter, in.data(), &inF, out.data(), &outF);
+            frames += outF;
+        }
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    } while (seconds < secondsPerRun);
+
+    ma_data_converter_uninit(&converter, nullptr);
+    return frames * test.to.channels / seconds;
+}
+
+int main() {
+    std::cout << "[SoundIO] format conversion benchmark (" << getMixKernelName() << ")" << std::endl;
+    std::cout << "block=" << blockFrames << " frames, msamples/s out" << std::endl;
+
+    const Case cases[] = {
+        { "s16 -> f32 stereo   ", { ma_format_s16, 2, sampleRate }, { ma_format_f32, 2, sampleRate } },
+        { "s32 -> f32 stereo   ", { ma_format_s32, 2, sampleRate }, { ma_format_f32, 2, sampleRate } },
+        { "f32 -> s16 stereo   ", { ma_format_f32, 2, sampleRate }, { ma_format_s16, 2, sampleRate } },
+        { "f32 -> s32 stereo   ", { ma_format_f32, 2, sampleRate }, { ma_format_s32, 2, sampleRate } },
+        { "f32 mono -> stereo  ", { ma_format_f32, 1, sampleRate }, { ma_format_f32, 2, sampleRate } },
+        { "f32 stereo -> mono  ", { ma_format_f32, 2, sampleRate }, { ma_format_f32, 1, sampleRate } },
+        { "s16 mono -> f32 st. ", { ma_format_s16, 1, sampleRate }, { ma_format_f32, 2, sampleRate } },
+    };
+
+    for (const Case& test : cases) {
+        std::vector<ma_uint8> in(test.from.frameSizeInBytes(blockFrames));
+        std::vector<ma_uint8> out(test.to.frameSizeInBytes(blockFrames));
+        for (size_t i = 0; i < in.size(); i++) in[i] = (ma_uint8)(i * 37);
+
+        double fast = runFast(test, in, out);
+        double reference = runMiniaudio(test, in, out);
+        std::cout << test.name << ": fast " << fast / 1e6 << ", ma_data_converter " << reference / 1e6
+                  << " (x" << fast / reference << ")" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,117 @@
+// SoundIO - File input decoding benchmark
+// Copyright (c) 2025 - (real)Coloride
+// https://github.com/realcoloride/soundio
+//
+// Renders a file input offline (MIT) into a wav with each way of reading it: decoding on the
+// rendering thread, decoding ahead on a background thread, and the shared asset cache.
+// Reports the realtime factor of each and checks every render against the plain decode,
+// sample for sample: a mode that falls back to silence or ends early shows as a mismatch.
+// Powered by miniaudio (https:://miniaud.io)
+
+#include <core/AudioFormat.h>
+#include <input/AudioFileInput.h>
+#include <output/AudioFileOutput.h>
+#include <output/AudioOfflineRenderer.h>
+#include <chrono>
+#include <iostream>
+
+// benchmark parameters
+const double secondsPerFile = 10.0;
+const AudioFormat sourceFormat(ma_format_s16, 2, 44100);
+const AudioFormat targetFormat(ma_format_f32, 2, 48000);
+const int runs = 3;
+
+enum class Mode { Plain, DecodeAhead, AssetCache };
+
+static void writeSource(const std::string& path) {
+    ma_encoder encoder;
+    ma_encoder_config config = ma_encoder_config_init(ma_encoding_format_wav,
+        sourceFormat.format, sourceFormat.channels, sourceFormat.sampleRate);
+    if (ma_encoder_init_file(path.c_str(), &config, &encoder) != MA_SUCCESS) return;
+
+    const ma_uint64 frames = (ma_uint64)(secondsPerFile * sourceFormat.sampleRate);
+    std::vector<ma_int16> samples((size_t)frames * sourceFormat.channels);
+    for (ma_uint64 i = 0; i < frames; i++)
+        samples[2 * i] = samples[2 * i + 1] = (ma_int16)(8000.0 * std::sin(i * 0.03));
+
+    ma_encoder_write_pcm_frames(&encoder, samples.data(), frames, nullptr);
+    ma_encoder_uninit(&encoder);
+}
+
+static std::vector<float> readRender(const std::string& path) {
+    ma_decoder_config config = ma_decoder_config_init(ma_format_f32, targetFormat.channels, targetFormat.sampleRate);
+    ma_decoder decoder;
+    if (ma_decoder_init_file(path.c_str(), &config, &decoder) != MA_SUCCESS) return {};
+
+    std::vector<float> samples;
+    std::vector<float> chunk(4096 * targetFormat.channels);
+    ma_uint64 read = 0;
+    do {
+        ma_decoder_read_pcm_frames(&decoder, chunk.data(), 4096, &read);
+        samples.insert(samples.end(), chunk.begin(), chunk.begin() + (size_t)read * targetFormat.channels);
+    } while (read == 4096);
+    ma_decoder_uninit(&decoder);
+    return samples;
+}
+
+// Seconds spent rendering input into output
+static double render(const std::string& input, const std::string& output, Mode mode, bool& finished) {
+    AudioFileInput file;
+    file.decodeAhead = mode == Mode::DecodeAhead;
+    file.useAssetCache = mode == Mode::AssetCache;
+    file.open(input);
+
+    AudioFileOutput sink;
+    sink.asyncWrite = false;
+    sink.open(output, targetFormat);
+    file.subscribe(&sink);
+
+    AudioOfflineRenderer renderer(&sink);
+    auto start = std::chrono::steady_clock::now();
+    renderer.render((ma_uint64)(secondsPerFile * 2 * targetFormat.sampleRate)); // bounded if the end is never seen
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    finished = renderer.isFinished();
+    sink.close();
+    return seconds;
+}
+
+int main() {
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "soundio_decode_benchmark";
+    std::filesystem::create_directories(directory);
+
+    std::cout << "[SoundIO] file input decoding benchmark" << std::endl;
+    std::cout << secondsPerFile << "s, s16 44.1k stereo -> f32 48k stereo, rendered offline" << std::endl;
+
+    const std::string input = (directory / "in.wav").string();
+    writeSource(input);
+
+    const struct { Mode mode; const char* name; } modes[] = {
+        { Mode::Plain, "plain       " },
+        { Mode::DecodeAhead, "decode-ahead" },
+        { Mode::AssetCache, "asset cache " },
+    };
+
+    std::vector<float> reference;
+    for (const auto& entry : modes) {
+        const std::string output = (directory / "out.wav").string();
+        double seconds = 0.0;
+        bool finished = false;
+        for (int i = 0; i < runs; i++)
+            seconds += render(input, output, entry.mode, finished);
+
+        const std::vector<float> rendered = readRender(output);
+        if (entry.mode == Mode::Plain) reference = rendered;
+        const bool matches = !rendered.empty() && rendered == reference;
+
+        std::cout << entry.name << std::fixed << std::setprecision(1)
+            << "  x realtime " << std::setw(7) << secondsPerFile * runs / seconds
+            << "  frames " << rendered.size() / targetFormat.channels
+            << (finished ? "" : "  NOT FINISHED")
+            << (matches ? "  matches plain" : "  MISMATCH") << std::endl;
+    }
+
+    std::error_code error;
+    std::filesystem::remove_all(directory, error);
+    return 0;
+}
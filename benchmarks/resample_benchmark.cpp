@@ -0,0 +1,148 @@
+// SoundIO - Resampler quality benchmark
+// Copyright (c) 2025 - (real)Coloride
+// https://github.com/realcoloride/soundio
+//
+// Measures each AudioResampleQuality tier (MIT): CPU cost as stereo streams one core keeps
+// up with in realtime, against quality as the SNR of a resampled tone (noise, distortion and
+// aliasing all count as error) and the rejection of a tone above the output Nyquist frequency.
+// Powered by miniaudio (https:://miniaud.io)
+
+#include <core/AudioConverter.h>
+#include <chrono>
+#include <iostream>
+
+// benchmark parameters
+const ma_uint32 blockFrames = 512;
+const double secondsPerRun = 0.25;
+const double toneSeconds = 1.0;
+
+struct Ratio {
+    const char* name;
+    ma_uint32 rateIn;
+    ma_uint32 rateOut;
+};
+
+// Resamples a mono tone of frequency hz in blocks, like an endpoint would
+static std::vector<float> resampleTone(const Ratio& ratio, AudioResampleQuality quality, double hz) {
+    AudioConverter converter;
+    converter.init({ ma_format_f32, 1, ratio.rateIn }, { ma_format_f32, 1, ratio.rateOut }, quality);
+
+    const size_t frames = (size_t)(ratio.rateIn * toneSeconds);
+    std::vector<float> in(frames);
+    for (size_t i = 0; i < frames; i++)
+        in[i] = (float)(0.5 * std::sin(2.0 * MA_PI_D * hz * i / ratio.rateIn));
+
+    std::vector<float> out;
+    std::vector<float> block(blockFrames * 4);
+    size_t offset = 0;
+    while (offset < frames) {
+        ma_uint64 inF = std::min<size_t>(blockFrames, frames - offset);
+        ma_uint64 outF = block.size();
+        converter.process(in.data() + offset, &inF, block.data(), &outF);
+        out.insert(out.end(), block.begin(), block.begin() + (size_t)outF);
+        offset += (size_t)inF;
+    }
+    return out;
+}
+
+// Power ratio of the best fitting sinusoid at hz to everything else, in dB. Fitting the phase
+// makes it independent of each resampler's delay.
+static double measureSNR(const std::vector<float>& signal, ma_uint32 rate, double hz) {
+    const size_t margin = rate / 10; // edges hold the filters' warm-up
+    if (signal.size() < margin * 3) return 0.0;
+
+    const double w = 2.0 * MA_PI_D * hz / rate;
+    double ss = 0, cc = 0, sc = 0, sy = 0, cy = 0;
+    for (size_t n = margin; n < signal.size() - margin; n++) {
+        const double s = std::sin(w * n), c = std::cos(w * n), y = signal[n];
+        ss += s * s; cc += c * c; sc += s * c; sy += s * y; cy += c * y;
+    }
+    const double det = ss * cc - sc * sc;
+    const double a = (sy * cc - cy * sc) / det;
+    const double b = (cy * ss - sy * sc) / det;
+
+    double tone = 0, error = 0;
+    for (size_t n = margin; n < signal.size() - margin; n++) {
+        const double fit = a * std::sin(w * n) + b * std::cos(w * n);
+        tone += fit * fit;
+        error += (signal[n] - fit) * (signal[n] - fit);
+    }
+    return 10.0 * std::log10(tone / std::max(error, 1e-30));
+}
+
+// Level of what is left of a tone the output can't represent, relative to the input, in dB
+static double measureRejection(const Ratio& ratio, AudioResampleQuality quality, double hz) {
+    const std::vector<float> out = resampleTone(ratio, quality, hz);
+    const size_t margin = ratio.rateOut / 10;
+    double power = 0;
+    size_t count = 0;
+    for (size_t n = margin; n + margin < out.size(); n++, count++)
+        power += (double)out[n] * out[n];
+    return 10.0 * std::log10(std::max(power / std::max<size_t>(count, 1), 1e-30) / 0.125);
+}
+
+// Stereo streams resampled in realtime by one core
+static double measureStreams(const Ratio& ratio, AudioResampleQuality quality) {
+    AudioConverter converter;
+    converter.init({ ma_format_f32, 2, ratio.rateIn }, { ma_format_f32, 2, ratio.rateOut }, quality);
+
+    std::vector<float> in(blockFrames * 2);
+    for (size_t i = 0; i < in.size(); i++) in[i] = (float)std::sin(i * 0.01);
+    std::vector<float> out(blockFrames * 2 * 4);
+
+    ma_uint64 frames = 0;
+    auto start = std::chrono::steady_clock::now();
+    double seconds = 0.0;
+    do {
+        for (int i = 0; i < 64; i++) {
+            ma_uint64 inF = blockFrames, outF = blockFrames * 4;
+            converter.process(in.data(), &inF, out.data(), &outF);
+            frames += inF;
+        }
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    } while (seconds < secondsPerRun);
+
+    return frames / seconds / ratio.rateIn;
+}
+
+int main() {
+    std::cout << "[SoundIO] resampler benchmark (" << getMixKernelName() << ")" << std::endl;
+    std::cout << "streams: stereo streams per core in realtime, snr: 1 kHz / high tone, reject: tone above the output Nyquist" << std::endl;
+
+    const Ratio ratios[] = {
+        { "44.1k -> 48k", 44100, 48000 },
+        { "48k -> 44.1k", 48000, 44100 },
+        { "48k -> 16k  ", 48000, 16000 },
+        { "16k -> 48k  ", 16000, 48000 },
+        { "22.05k -> 48k", 22050, 48000 },
+    };
+    const AudioResampleQuality qualities[] = {
+        AudioResampleQuality::Linear, AudioResampleQuality::Sinc, AudioResampleQuality::Offline
+    };
+
+    for (const Ratio& ratio : ratios) {
+        const ma_uint32 lower = std::min(ratio.rateIn, ratio.rateOut);
+        const double high = lower * 0.4; // well inside every tier's passband
+
+        std::cout << ratio.name << std::endl;
+        for (AudioResampleQuality quality : qualities) {
+            AudioResampler::prepare(quality, ratio.rateIn, ratio.rateOut);
+
+            const double streams = measureStreams(ratio, quality);
+            const double snrLow = measureSNR(resampleTone(ratio, quality, 1000.0), ratio.rateOut, 1000.0);
+            const double snrHigh = measureSNR(resampleTone(ratio, quality, high), ratio.rateOut, high);
+
+            std::cout << "  " << std::left << std::setw(8) << AudioResampler::getQualityName(quality) << std::right << std::fixed
+                << std::setprecision(0) << std::setw(7) << streams << " streams"
+                << std::setprecision(1) << "   snr " << std::setw(6) << snrLow << " / " << std::setw(6) << snrHigh << " dB";
+
+            if (ratio.rateOut < ratio.rateIn) {
+                // between the output Nyquist and the input's, aliases back into the audible band
+                const double above = ratio.rateOut * 0.5 + (ratio.rateIn - ratio.rateOut) * 0.25;
+                std::cout << "   reject " << std::setw(6) << measureRejection(ratio, quality, above) << " dB";
+            }
+            std::cout << std::endl;
+        }
+    }
+    return 0;
+}
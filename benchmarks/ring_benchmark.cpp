@@ -0,0 +1,148 @@
+// SoundIO - Ring buffer benchmark
+// Copyright (c) 2025 - (real)Coloride
+// https://github.com/realcoloride/soundio
+//
+// Compares ma_pcm_rb with SoundIO's lock-free AudioFrameRing (MIT).
+// Producer and consumer are pinned to different cores, frames/sec and
+// (on Linux) hardware cache misses are reported for each backend.
+// Powered by miniaudio (https:://miniaud.io)
+
+#include <core/AudioRing.h>
+#include <chrono>
+#include <thread>
+#include <iostream>
+
+#if defined(__linux__)
+    #include <pthread.h>
+    #include <sched.h>
+    #include <unistd.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <linux/perf_event.h>
+#elif defined(_WIN32)
+    #include <windows.h>
+#endif
+
+// benchmark parameters
+const ma_uint32 ringFrames = 4096;
+const ma_uint32 blockFrames = 256;
+const ma_uint64 totalFrames = 64ull * 1024 * 1024;
+const AudioFormat format = AudioFormat::Stereo48kF32();
+
+static void pinToCore(std::thread& thread, unsigned core) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core % std::thread::hardware_concurrency(), &set);
+    pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#elif defined(_WIN32)
+    SetThreadAffinityMask(thread.native_handle(), (DWORD_PTR)1 << (core % std::thread::hardware_concurrency()));
+#else
+    (void)thread; (void)core;
+#endif
+}
+
+// counts cache misses of this process and of the threads it spawns afterwards
+struct CacheMissCounter {
+    int fd = -1;
+
+    CacheMissCounter() {
+#if defined(__linux__)
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    // returns -1 when hardware counters are not available
+    long long stop() {
+#if defined(__linux__)
+        if (fd < 0) return -1;
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        long long count = 0;
+        if (read(fd, &count, sizeof(count)) != sizeof(count)) count = -1;
+        close(fd);
+        return count;
+#else
+        return -1;
+#endif
+    }
+};
+
+static void runBenchmark(const char* name, AudioRingBackend backend) {
+    AudioRing ring;
+    if (ring.init(format, ringFrames, backend) != MA_SUCCESS) {
+        std::cerr << name << ": ring init failed" << std::endl;
+        return;
+    }
+
+    const ma_uint32 frameSize = format.frameSizeInBytes();
+    std::vector<float> source(blockFrames * format.channels, 0.5f);
+    std::vector<float> destination(blockFrames * format.channels);
+
+    CacheMissCounter counter;
+    auto start = std::chrono::steady_clock::now();
+
+    std::thread producer([&]() {
+        ma_uint64 written = 0;
+        while (written < totalFrames) {
+            AudioRingSpans spans;
+            ma_uint32 frames = ring.acquireWrite(blockFrames, &spans);
+            if (frames == 0) { std::this_thread::yield(); continue; }
+
+            memcpy(spans.first, source.data(), (size_t)spans.firstFrames * frameSize);
+            if (spans.secondFrames > 0)
+                memcpy(spans.second, source.data() + spans.firstFrames * format.channels, (size_t)spans.secondFrames * frameSize);
+            ring.commitWrite(frames);
+            written += frames;
+        }
+    });
+
+    std::thread consumer([&]() {
+        ma_uint64 read = 0;
+        while (read < totalFrames) {
+            AudioRingSpans spans;
+            ma_uint32 frames = ring.acquireRead(blockFrames, &spans);
+            if (frames == 0) { std::this_thread::yield(); continue; }
+
+            memcpy(destination.data(), spans.first, (size_t)spans.firstFrames * frameSize);
+            if (spans.secondFrames > 0)
+                memcpy(destination.data() + spans.firstFrames * format.channels, spans.second, (size_t)spans.secondFrames * frameSize);
+            ring.commitRead(frames);
+            read += frames;
+        }
+    });
+
+    pinToCore(producer, 0);
+    pinToCore(consumer, 1);
+
+    producer.join();
+    consumer.join();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    long long misses = counter.stop();
+
+    std::cout << name << ": " << (ma_uint64)(totalFrames / seconds) << " frames/s";
+    if (misses >= 0) std::cout << ", " << misses << " cache misses (" << (double)misses / (totalFrames / blockFrames) << " per block)";
+    else std::cout << ", cache misses n/a";
+    std::cout << std::endl;
+}
+
+int main() {
+    std::cout << "[SoundIO] ring buffer benchmark" << std::endl;
+    std::cout << totalFrames << " frames, ring=" << ringFrames << " block=" << blockFrames << std::endl;
+
+    runBenchmark("ma_pcm_rb     ", AudioRingBackend::Miniaudio);
+    runBenchmark("AudioFrameRing", AudioRingBackend::LockFree);
+    return 0;
+}
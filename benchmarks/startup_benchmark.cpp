@@ -0,0 +1,129 @@
+// SoundIO - Device enumeration startup benchmark
+// Copyright (c) 2025 - (real)Coloride
+// https://github.com/realcoloride/soundio
+//
+// Measures SoundIO::initialize() and refreshDevices() (MIT) on the null backend and on a custom
+// backend listing many endpoints whose format query costs what opening a device costs on ALSA or
+// PulseAudio. "eager" probes every device like enumeration used to, "lazy" lists them and probes
+// one device on first use, "refresh" lists an unchanged system again.
+// Powered by miniaudio (https:://miniaud.io)
+
+#include <SoundIO.h>
+#include <chrono>
+#include <iostream>
+
+// benchmark parameters
+const ma_uint32 devicesPerType = 48;
+const ma_uint32 probeMicroseconds = 1500;
+const int runs = 3;
+
+// Custom backend: devicesPerType speakers and microphones, each format query sleeps like a device open
+static std::atomic<ma_uint32> probeCount{ 0 };
+
+static ma_result onEnumerate(ma_context* pContext, ma_enum_devices_callback_proc callback, void* pUserData) {
+    for (int type = 0; type < 2; type++) {
+        const ma_device_type deviceType = type == 0 ? ma_device_type_playback : ma_device_type_capture;
+        for (ma_uint32 i = 0; i < devicesPerType; i++) {
+            ma_device_info info;
+            memset(&info, 0, sizeof(info));
+            info.id.custom.i = (int)i + 1;
+            snprintf(info.name, sizeof(info.name), "%s %u", type == 0 ? "Speaker" : "Microphone", i);
+            info.isDefault = i == 0;
+            if (!callback(pContext, deviceType, &info, pUserData)) return MA_SUCCESS;
+        }
+    }
+    return MA_SUCCESS;
+}
+
+static ma_result onGetDeviceInfo(ma_context*, ma_device_type deviceType, const ma_device_id* pDeviceID, ma_device_info* pDeviceInfo) {
+    probeCount++;
+    std::this_thread::sleep_for(std::chrono::microseconds(probeMicroseconds));
+
+    memset(pDeviceInfo, 0, sizeof(*pDeviceInfo));
+    if (pDeviceID != nullptr) pDeviceInfo->id = *pDeviceID;
+    snprintf(pDeviceInfo->name, sizeof(pDeviceInfo->name), "%s %d",
+        deviceType == ma_device_type_playback ? "Speaker" : "Microphone", pDeviceID ? pDeviceID->custom.i - 1 : 0);
+
+    const ma_format formats[] = { ma_format_s16, ma_format_s32, ma_format_f32 };
+    const ma_uint32 rates[] = { 44100, 48000 };
+    for (ma_format format : formats)
+        for (ma_uint32 rate : rates) {
+            auto& native = pDeviceInfo->nativeDataFormats[pDeviceInfo->nativeDataFormatCount++];
+            native.format = format;
+            native.channels = 2;
+            native.sampleRate = rate;
+        }
+    return MA_SUCCESS;
+}
+
+static ma_result onContextInit(ma_context*, const ma_context_config*, ma_backend_callbacks* pCallbacks) {
+    pCallbacks->onContextEnumerateDevices = onEnumerate;
+    pCallbacks->onContextGetDeviceInfo = onGetDeviceInfo;
+    return MA_SUCCESS;
+}
+
+static double milliseconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void run(const std::string& name, ma_backend backend, const ma_context_config* config, bool countsProbes) {
+    double eager = 0, lazy = 0, firstUse = 0, refresh = 0;
+    ma_uint32 eagerProbes = 0, lazyProbes = 0, refreshProbes = 0;
+    size_t devices = 0;
+
+    for (int i = 0; i < runs; i++) {
+        // every device probed during startup
+        probeCount = 0;
+        auto start = std::chrono::steady_clock::now();
+        if (SoundIO::initialize(&backend, 1, config) != MA_SUCCESS) {
+            std::cout << name << ": backend unavailable" << std::endl;
+            return;
+        }
+        SoundIO::refreshDevices(true);
+        eager += milliseconds(start);
+        eagerProbes = probeCount;
+        SoundIO::shutdown();
+
+        // listed only, then the first device asked for its format
+        probeCount = 0;
+        start = std::chrono::steady_clock::now();
+        SoundIO::initialize(&backend, 1, config);
+        lazy += milliseconds(start);
+        lazyProbes = probeCount;
+        devices = SoundIO::getAllDevices().size();
+
+        start = std::chrono::steady_clock::now();
+        auto speakers = SoundIO::getAllSpeakers();
+        if (!speakers.empty()) speakers.front()->getDeviceFormat();
+        firstUse += milliseconds(start);
+
+        // nothing changed
+        probeCount = 0;
+        start = std::chrono::steady_clock::now();
+        SoundIO::refreshDevices();
+        refresh += milliseconds(start);
+        refreshProbes = probeCount;
+        SoundIO::shutdown();
+    }
+
+    auto probes = [countsProbes](ma_uint32 count) {
+        return countsProbes ? "  (" + std::to_string(count) + " probes)" : std::string();
+    };
+
+    std::cout << name << ", " << devices << " devices" << std::endl << std::fixed << std::setprecision(2)
+        << "  eager startup  " << std::setw(9) << eager / runs << " ms" << probes(eagerProbes) << std::endl
+        << "  lazy startup   " << std::setw(9) << lazy / runs << " ms" << probes(lazyProbes) << std::endl
+        << "  first format   " << std::setw(9) << firstUse / runs << " ms" << std::endl
+        << "  refresh        " << std::setw(9) << refresh / runs << " ms" << probes(refreshProbes) << std::endl;
+}
+
+int main() {
+    std::cout << "[SoundIO] device enumeration startup benchmark" << std::endl;
+
+    run("null backend", ma_backend_null, nullptr, false);
+
+    ma_context_config config = ma_context_config_init();
+    config.custom.onContextInit = onContextInit;
+    run("custom backend (" + std::to_string(probeMicroseconds) + " us per probe)", ma_backend_custom, &config, true);
+    return 0;
+}
@@ -0,0 +1,78 @@
+// SoundIO - Batch transcoding benchmark
+// Copyright (c) 2025 - (real)Coloride
+// https://github.com/realcoloride/soundio
+//
+// Measures AudioBatchTranscoder's throughput (MIT): a fixed batch of wav files resampled
+// and converted with 1, 2, 4... worker threads up to the hardware thread count.
+// Powered by miniaudio (https:://miniaud.io)
+
+#include <core/AudioTranscoder.h>
+#include <chrono>
+#include <iostream>
+
+// benchmark parameters
+const int fileCount = 48;
+const double secondsPerFile = 10.0;
+const AudioFormat sourceFormat(ma_format_s16, 2, 44100);
+const AudioFormat targetFormat(ma_format_f32, 2, 48000);
+
+static void writeSource(const std::string& path) {
+    ma_encoder encoder;
+    ma_encoder_config config = ma_encoder_config_init(ma_encoding_format_wav,
+        sourceFormat.format, sourceFormat.channels, sourceFormat.sampleRate);
+    if (ma_encoder_init_file(path.c_str(), &config, &encoder) != MA_SUCCESS) return;
+
+    const ma_uint64 frames = (ma_uint64)(secondsPerFile * sourceFormat.sampleRate);
+    std::vector<ma_int16> samples((size_t)frames * sourceFormat.channels);
+    for (ma_uint64 i = 0; i < frames; i++)
+        samples[2 * i] = samples[2 * i + 1] = (ma_int16)(8000.0 * std::sin(i * 0.03));
+
+    ma_encoder_write_pcm_frames(&encoder, samples.data(), frames, nullptr);
+    ma_encoder_uninit(&encoder);
+}
+
+int main() {
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "soundio_transcode_benchmark";
+    std::filesystem::create_directories(directory);
+
+    std::cout << "[SoundIO] batch transcoding benchmark" << std::endl;
+    std::cout << fileCount << " files x " << secondsPerFile << "s, s16 44.1k stereo -> f32 48k stereo" << std::endl;
+
+    std::vector<AudioTranscodeJob> jobs;
+    for (int i = 0; i < fileCount; i++) {
+        const std::string input = (directory / ("in" + std::to_string(i) + ".wav")).string();
+        writeSource(input);
+        jobs.push_back({ input, (directory / ("out" + std::to_string(i) + ".wav")).string(), targetFormat });
+    }
+
+    const size_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+    double baseline = 0.0;
+
+    for (size_t threads = 1; ; threads = std::min(threads * 2, hardwareThreads)) {
+        AudioBatchTranscoder batch(threads);
+
+        auto start = std::chrono::steady_clock::now();
+        batch.submit(jobs);
+        batch.wait();
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        size_t failed = 0;
+        for (const AudioTranscodeResult& result : batch.getResults())
+            failed += result.state != AudioTranscodeState::Done;
+
+        const double filesPerSecond = fileCount / seconds;
+        if (threads == 1) baseline = filesPerSecond;
+
+        std::cout << "threads " << threads
+            << "  files/s " << filesPerSecond
+            << "  x realtime " << fileCount * secondsPerFile / seconds
+            << "  speedup " << filesPerSecond / baseline
+            << (failed ? "  FAILED " + std::to_string(failed) : "") << std::endl;
+
+        if (threads == hardwareThreads) break;
+    }
+
+    std::error_code error;
+    std::filesystem::remove_all(directory, error);
+    return 0;
+}
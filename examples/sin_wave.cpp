@@ -7,7 +7,7 @@
 
 #include <SoundIO.h>
 #include <cmath>
-#include <vector>
+#include <algorithm>
 #include <thread>
 #include <iostream>
 
@@ -56,19 +56,11 @@ int main() {
     std::cout << "starting generation..." << std::endl;
     std::cout << "sine wave is playing... (" << duration << "s)" << std::endl;
     
-    // main generation loop
-    while (framesLeft > 0) {
-        // calculate current batch size (remaining frames or max batch size)
-        ma_uint32 currentBatch = min(batchFrames, (ma_uint32)framesLeft);
-        
-        // wait until there's enough space in the audio buffer
-        while (stream->getAvailableWriteFrames() < currentBatch)
-            std::this_thread::yield();
-
-        // generate audio samples for this batch
-        std::vector<float> buffer(currentBatch * format.channels);
+    // generates frames straight into the stream's ring memory
+    auto generate = [&](void* pOut, ma_uint32 frames) {
+        float* samples = static_cast<float*>(pOut);
 
-        for (ma_uint32 j = 0; j < currentBatch; ++j) {
+        for (ma_uint32 j = 0; j < frames; ++j) {
             // generate sin wave sample
             float sample = amplitude * std::sin(phase);
             phase += twoPiF;
@@ -78,12 +70,30 @@ int main() {
             
             // copy sample to all audio channels (mono -> stereo/multichannel)
             for (ma_uint32 ch = 0; ch < format.channels; ++ch)
-                buffer[j * format.channels + ch] = sample;
+                samples[j * format.channels + ch] = sample;
         }
+    };
+
+    // main generation loop
+    while (framesLeft > 0) {
+        // calculate current batch size (remaining frames or max batch size)
+        ma_uint32 currentBatch = std::min(batchFrames, (ma_uint32)framesLeft);
         
-        // submit audio data to the stream
-        stream->submitPCM(buffer.data(), currentBatch);
-        framesLeft -= currentBatch;
+        // reserve space in the audio buffer, wait if it is full
+        AudioRingSpans spans = stream->acquireWrite(currentBatch);
+        if (spans.totalFrames() == 0) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        // generate audio samples in place (the second span is set when the ring wraps around)
+        generate(spans.first, spans.firstFrames);
+        if (spans.secondFrames > 0)
+            generate(spans.second, spans.secondFrames);
+
+        // publish audio data to the stream
+        stream->commitWrite(spans.totalFrames());
+        framesLeft -= spans.totalFrames();
     }
 
     // wait for the sine wave to be processed
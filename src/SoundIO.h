@@ -6,6 +6,7 @@ constexpr int SOUNDIO_VERSION = 100;
 
 // core
 #include "./core/AudioFormat.h"
+#include "./core/AudioTranscoder.h"
 
 // device
 #include "./device/AudioDevice.h"
@@ -19,9 +20,11 @@ constexpr int SOUNDIO_VERSION = 100;
 // mixer
 #include "./mixer/AudioAnalyzer.h"
 #include "./mixer/AudioCombiner.h"
+#include "./mixer/AudioMixer.h"
 
 // output
 #include "./output/AudioFileOutput.h"
+#include "./output/AudioOfflineRenderer.h"
 #include "./output/AudioStreamOutput.h"
 
 // player
@@ -35,11 +38,15 @@ class SoundIO {
 private:    
     static inline ma_context context;
     static inline std::unordered_map<std::string, int> missingCount;
+    static inline std::unordered_map<std::string, std::string> normalizedIds; // raw id + type -> normalized id
 
     static inline bool initialized = false;
 
     static inline std::map<std::string, std::shared_ptr<AudioDevice>> idToDevices;
 
+    // Guards idToDevices and nodes. Recursive: refreshDevices() goes through getDeviceById() and addDevice()
+    static inline std::recursive_mutex registryMutex;
+
     static ma_result onDeviceInit(
         ma_device* pDevice, const ma_device_config* pConfig,
         ma_device_descriptor* pDescriptorPlayback, ma_device_descriptor* pDescriptorCapture
@@ -64,9 +71,7 @@ private:
         const ma_device_info& deviceInfo,
         ma_device_type deviceType,
         const std::string& normalizedDeviceId,
-        ma_format format,
-        ma_uint32 sampleRate,
-        ma_uint32 channels,
+        bool probeAll,
         T*& defaultDevice,
         std::function<std::shared_ptr<T>()> creationCallback
     ) {
@@ -80,7 +85,8 @@ private:
             addDevice(std::move(newDevice));
         }
 
-        device->updateDevice(deviceInfo, deviceType, format, sampleRate, channels);
+        device->updateDevice(deviceInfo, deviceType);
+        if (probeAll) device->probe();
 
         if (device->isDefault)
             defaultDevice = device;
@@ -88,11 +94,18 @@ private:
 
 public:
     /// <summary>
-    /// Initializes SoundIO and devices.
+    /// Initializes SoundIO and lists devices. Device formats are probed later, on first use.
     /// </summary>
     /// <returns>Initialization result</returns>
     static ma_result initialize();
 
+    /// <summary>
+    /// Initializes SoundIO on the given backends, tried in order. Requesting ma_backend_null (silent
+    /// devices, headless hosts) or ma_backend_custom (callbacks in config->custom) is allowed here.
+    /// </summary>
+    /// <returns>Initialization result</returns>
+    static ma_result initialize(const ma_backend* backends, ma_uint32 backendCount, const ma_context_config* config = nullptr);
+
     /// <summary>
     /// Shuts down SoundIO, releases devices and uninitializes contexts.
     /// </summary>
@@ -100,9 +113,12 @@ public:
     static ma_result shutdown() {
         if (!initialized) return MA_SUCCESS;
 
+        std::unique_lock<std::recursive_mutex> lock(registryMutex);
         idToDevices.clear();
         nodes.clear();
+        lock.unlock();
         missingCount.clear();
+        normalizedIds.clear();
 
         ma_result result = ma_context_uninit(&context);
 
@@ -119,10 +135,12 @@ protected:
     template <typename T>
     static void addDevice(std::shared_ptr<T> device) {
         static_assert(std::is_base_of<AudioDevice, T>::value, "T must derive from AudioDevice");
+        std::lock_guard<std::recursive_mutex> lock(registryMutex);
         idToDevices.emplace(device->id, std::move(device));
     }
 
     static void removeDevice(const std::string& deviceId) {
+        std::lock_guard<std::recursive_mutex> lock(registryMutex);
         auto it = idToDevices.find(deviceId);
         if (it != idToDevices.end())
             idToDevices.erase(it); 
@@ -130,10 +148,11 @@ protected:
 
 public:
     /// <summary>
-    /// Forces a device list refresh
+    /// Forces a device list refresh. Only devices that are new or changed are probed again, on their next use.
     /// </summary>
+    /// <param name="probeAll">Probes every device now, picks up format changes made in the system settings</param>
     /// <returns>Refresh result</returns>
-    static ma_result refreshDevices();
+    static ma_result refreshDevices(bool probeAll = false);
 
     /// <summary>
     /// Gets a device by its normalized id
@@ -141,6 +160,7 @@ public:
     /// <param name="id">Normalized device id</param>
     /// <returns>Device if found, nullptr if not</returns>
     static AudioDevice* getDeviceById(const std::string& id) {
+        std::lock_guard<std::recursive_mutex> lock(registryMutex);
         auto it = idToDevices.find(id);
         return it != idToDevices.end() ? it->second.get() : nullptr;
     }
@@ -150,6 +170,7 @@ public:
     /// </summary>
     /// <returns>A vector of the following devices</returns>
     static std::vector<AudioDevice*> getAllDevices() {
+        std::lock_guard<std::recursive_mutex> lock(registryMutex);
         std::vector<AudioDevice*> out;
         out.reserve(idToDevices.size());
         for (auto& kv : idToDevices)
@@ -162,6 +183,7 @@ public:
     /// </summary>
     /// <returns>A vector of the following devices</returns>
     static std::vector<AudioMicrophoneDevice*> getAllMicrophones() {
+        std::lock_guard<std::recursive_mutex> lock(registryMutex);
         std::vector<AudioMicrophoneDevice*> out;
         out.reserve(idToDevices.size());
         for (auto& kv : idToDevices)
@@ -175,6 +197,7 @@ public:
     /// </summary>
     /// <returns>A vector of the following devices</returns>
     static std::vector<AudioSpeakerDevice*> getAllSpeakers() {
+        std::lock_guard<std::recursive_mutex> lock(registryMutex);
         std::vector<AudioSpeakerDevice*> out;
         out.reserve(idToDevices.size());
         for (auto& kv : idToDevices)
@@ -217,6 +240,36 @@ public:
         return speaker;
     }
 
+    /// <summary>
+    /// Snapshots the counters of every device and node created through SoundIO.
+    /// Only reads atomics, the audio thread is never locked. The device and node lists are
+    /// copied under the registry lock, so a concurrent refreshDevices() cannot free them meanwhile.
+    /// </summary>
+    /// <param name="resetFill">Starts a new fill range window for every endpoint</param>
+    /// <returns>One entry per endpoint, devices first</returns>
+    static std::vector<AudioEndpointStats> collectStats(bool resetFill = true) {
+        std::vector<std::pair<std::shared_ptr<AudioDevice>, std::string>> devices; // name is rewritten on refresh
+        std::vector<std::shared_ptr<AudioNode>> endpoints;
+        {
+            std::lock_guard<std::recursive_mutex> lock(registryMutex);
+            devices.reserve(idToDevices.size());
+            for (auto& kv : idToDevices) devices.emplace_back(kv.second, kv.second->name);
+            endpoints = nodes;
+        }
+
+        std::vector<AudioEndpointStats> out;
+        out.reserve(devices.size() + endpoints.size());
+
+        for (auto& device : devices) {
+            out.push_back(device.first->getStats(resetFill));
+            out.back().name = device.second;
+        }
+        for (auto& node : endpoints)
+        if (auto* endpoint = dynamic_cast<AudioEndpoint*>(node.get()))
+            out.push_back(endpoint->getStats(resetFill));
+        return out;
+    }
+
 protected:
     static inline std::vector<std::shared_ptr<AudioNode>> nodes;
 
@@ -227,6 +280,7 @@ protected:
 
         auto ptr = std::make_shared<T>(std::forward<Args>(args)...);
         T* raw = ptr.get();
+        std::lock_guard<std::recursive_mutex> lock(registryMutex);
         nodes.push_back(std::move(ptr)); // nodes = std::vector<std::shared_ptr<AudioNode>>
         return raw;
     }
@@ -243,10 +297,12 @@ public:
     }
 
     // mixer
-    /*static AudioCombiner* createCombiner(AudioInput* input = nullptr, AudioOutput* device = nullptr) {
-        
+    static AudioCombiner* createCombiner(const AudioFormat& format = AudioFormat::Stereo48kF32()) {
+        return registerNode<AudioCombiner>(format);
+    }
+    static AudioAnalyzer* createAnalyzer(const AudioFormat& format = AudioFormat::Stereo48kF32(), ma_uint32 fftSize = 2048) {
+        return registerNode<AudioAnalyzer>(format, fftSize);
     }
-    */
 
     // output
     
@@ -268,12 +324,21 @@ public:
 };
 
 inline ma_result SoundIO::initialize() {
+    return initialize(NULL, 0, NULL);
+}
+
+inline ma_result SoundIO::initialize(const ma_backend* backends, ma_uint32 backendCount, const ma_context_config* config) {
     if (initialized) return MA_NO_MESSAGE;
 
-    // initialize miniaudio context with default backends
-    ma_result result = ma_context_init(NULL, 0, NULL, &context);
+    // initialize miniaudio context, default backends unless given
+    ma_result result = ma_context_init(backends, backendCount, config, &context);
     if (result != MA_SUCCESS) return result;
-    if (context.backend == ma_backend_null) return MA_BACKEND_NOT_ENABLED;
+
+    // only reached by default when no real backend works
+    if (backends == NULL && context.backend == ma_backend_null) {
+        ma_context_uninit(&context);
+        return MA_BACKEND_NOT_ENABLED;
+    }
 
     // setup callbacks
     SI_LOG("SoundIO initialize: backend=" << context.backend);
@@ -283,13 +348,14 @@ inline ma_result SoundIO::initialize() {
     return result;
 }
 
-inline ma_result SoundIO::refreshDevices() {
+inline ma_result SoundIO::refreshDevices(bool probeAll) {
     ma_device_info* speakers;
     ma_uint32 speakerCount;
     ma_device_info* microphones;
     ma_uint32 microphoneCount;
 
     SI_LOG("refreshDevices() called from:");
+    std::lock_guard<std::recursive_mutex> lock(registryMutex);
 
     ma_context_get_devices(&context, &speakers, &speakerCount, &microphones, &microphoneCount);
     SI_LOG("refreshDevices: speakers=" << speakerCount << " mics=" << microphoneCount);
@@ -302,9 +368,9 @@ inline ma_result SoundIO::refreshDevices() {
     // track all IDs we encounter this refresh
     std::unordered_set<std::string> seenIds;
 
-    loopDevices(context, speakers, speakerCount, ma_device_type_playback,
-        [&result, &defaultSpeaker, &seenIds]
-        (ma_device_info deviceInfo, std::string normalizedDeviceId, ma_format format, ma_uint32 sampleRate, ma_uint32 channels) {
+    loopDevices(context, speakers, speakerCount, ma_device_type_playback, normalizedIds,
+        [&result, &defaultSpeaker, &seenIds, probeAll]
+        (const ma_device_info& deviceInfo, const std::string& normalizedDeviceId) {
             seenIds.insert(normalizedDeviceId);
 
             auto creationCallback = [&normalizedDeviceId]() -> std::shared_ptr<AudioSpeakerDevice> {
@@ -312,7 +378,7 @@ inline ma_result SoundIO::refreshDevices() {
             };
 
             handleDeviceLoop<AudioSpeakerDevice>(
-                deviceInfo, ma_device_type_playback, normalizedDeviceId, format, sampleRate, channels,
+                deviceInfo, ma_device_type_playback, normalizedDeviceId, probeAll,
                 defaultSpeaker, creationCallback
             );
         }
@@ -320,9 +386,9 @@ inline ma_result SoundIO::refreshDevices() {
 
     if (result != MA_SUCCESS) return result;
 
-    loopDevices(context, microphones, microphoneCount, ma_device_type_capture,
-        [&result, &defaultMicrophone, &seenIds]
-        (ma_device_info deviceInfo, std::string normalizedDeviceId, ma_format format, ma_uint32 sampleRate, ma_uint32 channels) {
+    loopDevices(context, microphones, microphoneCount, ma_device_type_capture, normalizedIds,
+        [&result, &defaultMicrophone, &seenIds, probeAll]
+        (const ma_device_info& deviceInfo, const std::string& normalizedDeviceId) {
             seenIds.insert(normalizedDeviceId);
 
             auto creationCallback = [&normalizedDeviceId]() -> std::shared_ptr<AudioMicrophoneDevice> {
@@ -330,7 +396,7 @@ inline ma_result SoundIO::refreshDevices() {
             };
 
             handleDeviceLoop<AudioMicrophoneDevice>(
-                deviceInfo, ma_device_type_capture, normalizedDeviceId, format, sampleRate, channels,
+                deviceInfo, ma_device_type_capture, normalizedDeviceId, probeAll,
                 defaultMicrophone, creationCallback
             );
         }
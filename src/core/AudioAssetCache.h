@@ -0,0 +1,329 @@
+#pragma once
+
+#include "../include.h"
+#include "./AudioFormat.h"
+#include "./AudioResampler.h"
+
+// AudioAssetCache:
+// - Process-wide LRU of fully decoded files, keyed by path, modification time, format and resampler.
+//   Fifty inputs playing the same sound effect share one decode and one read-only buffer.
+// - Byte budget: least recently used assets are evicted once the budget is exceeded. An evicted
+//   asset stays alive for the inputs still playing it (shared_ptr), only the cache forgets it.
+// - Inputs asking for an asset that is being decoded wait for that decode instead of starting another.
+// - Files found too big are remembered with the limit they broke, so they are streamed right away
+//   instead of being decoded up to that limit again on every renegotiation. The last 256 are kept.
+// - Assets are decoded in the file's own format then converted, so the decoder an input probed
+//   the file with can fill the cache rather than a second one being opened.
+// - Decoding happens on the caller's thread (a renegotiation), never on an audio callback.
+
+struct AudioDecodedAsset {
+    AudioFormat format;
+    std::vector<ma_uint8> frames;
+    ma_uint64 frameCount = 0;
+
+    size_t getSizeInBytes() const { return frames.size(); }
+};
+
+struct AudioAssetCacheStats {
+    ma_uint64 hits = 0;       // served from the cache, or from a decode already running
+    ma_uint64 misses = 0;     // decoded
+    ma_uint64 evictions = 0;
+    ma_uint64 rejected = 0;   // decodes that failed or did not fit maxAssetBytes
+    size_t entries = 0;
+    size_t bytes = 0;
+    size_t budgetBytes = 0;
+};
+
+class AudioAssetCache {
+private:
+    using Asset = std::shared_ptr<const AudioDecodedAsset>;
+
+    struct Key {
+        std::string path;
+        ma_int64 modified = 0;
+        AudioFormat format;
+        AudioResampleQuality quality = AudioResampleQuality::Linear;
+
+        bool operator==(const Key& other) const {
+            return modified == other.modified && format == other.format && quality == other.quality && path == other.path;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            size_t hash = std::hash<std::string>()(key.path);
+            hash ^= std::hash<ma_int64>()(key.modified) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+            hash ^= ((size_t)key.format.format << 40) ^ ((size_t)key.format.channels << 32) ^ key.format.sampleRate ^ ((size_t)key.quality << 56);
+            return hash;
+        }
+    };
+
+    struct Entry {
+        Key key;
+        Asset asset;
+    };
+
+    mutable std::mutex mutex;
+    std::list<Entry> lru; // most recent first
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> entries;
+    std::unordered_map<Key, std::shared_future<Asset>, KeyHash> loading;
+    std::unordered_map<Key, size_t, KeyHash> tooBig; // limit each one exceeded
+    std::deque<Key> tooBigOrder;                      // first refused first
+    static constexpr size_t maxTooBig = 256;
+    size_t bytes = 0;
+    size_t budgetBytes = 64 * 1024 * 1024;
+    size_t maxAssetBytes = 16 * 1024 * 1024;
+    AudioAssetCacheStats counters;
+
+    static bool makeKey(const std::string& path, const AudioFormat& format, AudioResampleQuality quality, Key& key) {
+        std::error_code error;
+        std::filesystem::path canonical = std::filesystem::weakly_canonical(path, error);
+        if (error) return false;
+
+        const auto modified = std::filesystem::last_write_time(canonical, error);
+        if (error) return false;
+
+        key.path = canonical.string();
+        key.modified = (ma_int64)modified.time_since_epoch().count();
+        key.format = format;
+        key.quality = quality;
+        return true;
+    }
+
+    // Whole file read from source, opened in the file's own format, converted to format.
+    // MA_TOO_BIG once it grows past limit. source is left at its end.
+    static ma_result decode(ma_decoder& source, const AudioFormat& format, AudioResampleQuality quality, size_t limit, Asset& out) {
+        ma_format nativeFormat = ma_format_unknown;
+        ma_uint32 nativeChannels = 0;
+        ma_uint32 nativeRate = 0;
+        ma_channel nativeMap[MA_MAX_CHANNELS];
+        if (ma_decoder_get_data_format(&source, &nativeFormat, &nativeChannels, &nativeRate, nativeMap, MA_MAX_CHANNELS) != MA_SUCCESS)
+            return MA_INVALID_FILE;
+
+        auto asset = std::make_shared<AudioDecodedAsset>();
+        asset->format = AudioFormat(
+            format.format != ma_format_unknown ? format.format : nativeFormat,
+            format.channels != 0 ? format.channels : nativeChannels,
+            format.sampleRate != 0 ? format.sampleRate : nativeRate
+        );
+        const ma_uint32 frameSize = asset->format.frameSizeInBytes();
+        const ma_uint32 nativeFrameSize = ma_get_bytes_per_frame(nativeFormat, nativeChannels);
+
+        // the conversion a decoder opened in format would do
+        ma_data_converter_config config = ma_data_converter_config_init(
+            nativeFormat, asset->format.format,
+            nativeChannels, asset->format.channels,
+            nativeRate, asset->format.sampleRate
+        );
+        config.pChannelMapIn = nativeMap;
+        config.allowDynamicSampleRate = MA_FALSE;
+        config.resampling = ma_resampler_config_init(ma_format_unknown, 0, 0, 0, ma_resample_algorithm_linear); // a decoder's defaults
+        AudioResampler::configure(config.resampling, quality);
+
+        ma_data_converter converter;
+        if (ma_data_converter_init(&config, nullptr, &converter) != MA_SUCCESS) return MA_INVALID_FILE;
+
+        ma_uint64 length = 0;
+        if (ma_decoder_get_length_in_pcm_frames(&source, &length) == MA_SUCCESS && length > 0) {
+            length = length * asset->format.sampleRate / nativeRate;
+            if (length * frameSize > limit) {
+                ma_data_converter_uninit(&converter, nullptr);
+                return MA_TOO_BIG;
+            }
+            asset->frames.reserve((size_t)(length * frameSize));
+        }
+
+        // the length is an estimate for some codecs, read until the end
+        const ma_uint32 chunkFrames = 16384;
+        std::vector<ma_uint8> chunk((size_t)chunkFrames * nativeFrameSize);
+        while (asset->frames.size() <= limit) {
+            ma_uint64 read = 0;
+            ma_decoder_read_pcm_frames(&source, chunk.data(), chunkFrames, &read);
+
+            for (ma_uint64 consumed = 0; consumed < read;) {
+                ma_uint64 inFrames = read - consumed;
+                ma_uint64 outFrames = 0;
+                ma_data_converter_get_expected_output_frame_count(&converter, inFrames, &outFrames);
+                outFrames += 16; // rounding of the resampler's fractional position
+
+                const size_t offset = asset->frames.size();
+                asset->frames.resize(offset + (size_t)outFrames * frameSize);
+                ma_data_converter_process_pcm_frames(&converter,
+                    chunk.data() + (size_t)consumed * nativeFrameSize, &inFrames,
+                    asset->frames.data() + offset, &outFrames);
+                asset->frames.resize(offset + (size_t)outFrames * frameSize);
+
+                consumed += inFrames;
+                if (inFrames == 0 && outFrames == 0) break; // no progress, drop the rest
+            }
+            if (read < chunkFrames) break;
+        }
+        ma_data_converter_uninit(&converter, nullptr);
+
+        if (asset->frames.size() > limit) return MA_TOO_BIG;
+        if (asset->frames.empty()) return MA_INVALID_FILE;
+
+        asset->frames.shrink_to_fit();
+        asset->frameCount = asset->frames.size() / frameSize;
+        out = asset;
+        return MA_SUCCESS;
+    }
+
+    static ma_result decode(const std::string& path, const AudioFormat& format, AudioResampleQuality quality, size_t limit, Asset& out) {
+        ma_decoder source;
+        if (ma_decoder_init_file(path.c_str(), nullptr, &source) != MA_SUCCESS) return MA_INVALID_FILE;
+
+        const ma_result result = decode(source, format, quality, limit, out);
+        ma_decoder_uninit(&source);
+        return result;
+    }
+
+    // under mutex, oldest refusals go first
+    void rememberTooBig(const Key& key, size_t limit) {
+        if (tooBig.find(key) == tooBig.end()) {
+            tooBigOrder.push_back(key);
+            while (tooBigOrder.size() > maxTooBig) {
+                tooBig.erase(tooBigOrder.front());
+                tooBigOrder.pop_front();
+            }
+        }
+        tooBig[key] = limit;
+    }
+
+    // under mutex
+    void evictUntil(size_t target) {
+        while (bytes > target && !lru.empty()) {
+            Entry& oldest = lru.back();
+            bytes -= oldest.asset->getSizeInBytes();
+            entries.erase(oldest.key);
+            lru.pop_back();
+            counters.evictions++;
+        }
+    }
+
+public:
+    /// <summary>
+    /// The cache file inputs share.
+    /// </summary>
+    static AudioAssetCache& shared() {
+        static AudioAssetCache cache;
+        return cache;
+    }
+
+    /// <summary>
+    /// Decoded frames of path in format (a zero sample rate keeps the file's own), decoded on a miss.
+    /// quality is the resampler used when the file's rate differs, assets of different tiers are kept apart.
+    /// </summary>
+    /// <param name="asset">Receives the shared buffer, null on failure</param>
+    /// <param name="opened">Decoder already opened on path in the file's own format, read from on a miss
+    /// instead of opening the file again. Left at an unspecified position.</param>
+    /// <returns>MA_TOO_BIG when the decoded file would exceed maxAssetBytes, MA_INVALID_FILE when it can't be decoded</returns>
+    ma_result acquire(const std::string& path, const AudioFormat& format, std::shared_ptr<const AudioDecodedAsset>& asset,
+        AudioResampleQuality quality = AudioResampleQuality::Linear, ma_decoder* opened = nullptr) {
+        asset = nullptr;
+        Key key;
+        if (!makeKey(path, format, quality, key)) return MA_DOES_NOT_EXIST;
+
+        std::promise<Asset> promise;
+        size_t limit = 0;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            auto found = entries.find(key);
+            if (found != entries.end()) {
+                lru.splice(lru.begin(), lru, found->second);
+                counters.hits++;
+                asset = found->second->asset;
+                return MA_SUCCESS;
+            }
+
+            // already known not to fit, unless the limit grew since
+            auto refused = tooBig.find(key);
+            if (refused != tooBig.end() && std::min(maxAssetBytes, budgetBytes) <= refused->second)
+                return MA_TOO_BIG;
+
+            auto pending = loading.find(key);
+            if (pending != loading.end()) {
+                std::shared_future<Asset> future = pending->second;
+                counters.hits++;
+                lock.unlock();
+
+                asset = future.get();
+                return asset ? MA_SUCCESS : MA_ERROR; // that decode failed
+            }
+
+            loading.emplace(key, promise.get_future().share());
+            counters.misses++;
+            limit = std::min(maxAssetBytes, budgetBytes);
+        }
+
+        Asset decoded;
+        const ma_result result = opened != nullptr
+            ? decode(*opened, format, quality, limit, decoded)
+            : decode(key.path, format, quality, limit, decoded);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            loading.erase(key);
+
+            if (decoded == nullptr) {
+                counters.rejected++;
+                if (result == MA_TOO_BIG) rememberTooBig(key, limit);
+            } else if (decoded->getSizeInBytes() <= budgetBytes) {
+                evictUntil(budgetBytes - decoded->getSizeInBytes());
+                lru.push_front({ key, decoded });
+                entries[key] = lru.begin();
+                bytes += decoded->getSizeInBytes();
+            }
+        }
+        promise.set_value(decoded);
+
+        asset = decoded;
+        return result;
+    }
+
+    /// <summary>
+    /// Bytes of decoded audio the cache keeps, assets past it are evicted least recently used first.
+    /// Default is 64 MiB.
+    /// </summary>
+    void setBudget(size_t budget) {
+        std::lock_guard<std::mutex> lock(mutex);
+        budgetBytes = budget;
+        evictUntil(budgetBytes);
+    }
+
+    /// <summary>
+    /// Largest decoded file cached, longer files are streamed by their input. Default is 16 MiB.
+    /// </summary>
+    void setMaxAssetBytes(size_t maxBytes) {
+        std::lock_guard<std::mutex> lock(mutex);
+        maxAssetBytes = maxBytes;
+    }
+
+    size_t getBudget() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return budgetBytes;
+    }
+
+    /// <summary>
+    /// Forgets every asset and every file found too big, the assets still playing stay alive until their inputs drop them.
+    /// </summary>
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        evictUntil(0);
+        tooBig.clear();
+        tooBigOrder.clear();
+    }
+
+    AudioAssetCacheStats getStats() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        AudioAssetCacheStats out = counters;
+        out.entries = entries.size();
+        out.bytes = bytes;
+        out.budgetBytes = budgetBytes;
+        return out;
+    }
+
+    void resetStats() {
+        std::lock_guard<std::mutex> lock(mutex);
+        counters = AudioAssetCacheStats();
+    }
+};
@@ -0,0 +1,166 @@
+#pragma once
+
+#include "../include.h"
+#include "./AudioRing.h"
+
+// What happens when a fanned-out subscriber cannot keep up.
+// - DropSlowest: the writer never waits, a lagging subscriber skips ahead to the
+//   oldest frame still stored and the skipped frames are counted as dropped.
+// - DropNewest: the writer is bounded by the slowest subscriber, frames that do
+//   not fit are dropped for everyone.
+enum class AudioFanoutPolicy {
+    DropSlowest,
+    DropNewest
+};
+
+// AudioBroadcastRing:
+// - Single producer, multiple consumer frame FIFO, frames are stored once.
+// - Every subscriber owns a read cursor on its own cache line (heap allocated).
+// - Storage is twice the usable size so the writer never touches the window a
+//   subscriber is allowed to read (DropSlowest), a late reader that was lapped
+//   while copying discards what it read.
+
+class AudioBroadcastRing {
+private:
+    struct Cursor {
+        alignas(SOUNDIO_CACHE_LINE_SIZE) std::atomic<ma_uint64> readIndex{ 0 };
+        std::atomic<ma_uint64> droppedFrames{ 0 };
+    };
+
+    std::atomic<ma_uint64> writeIndex{ 0 };
+
+    std::vector<std::unique_ptr<Cursor>> cursors;
+    ma_uint8* buffer = nullptr;
+    ma_uint32 capacityFrames = 0;
+    ma_uint32 limitFrames = 0;
+    ma_uint32 mask = 0;
+    ma_uint32 frameSize = 0;
+    AudioFanoutPolicy policy = AudioFanoutPolicy::DropSlowest;
+
+    void fillSpans(ma_uint64 index, ma_uint32 frames, AudioRingSpans* spans) const {
+        const ma_uint32 offset = (ma_uint32)(index & mask);
+        const ma_uint32 firstFrames = std::min(frames, capacityFrames - offset);
+
+        spans->first = buffer + (size_t)offset * frameSize;
+        spans->firstFrames = firstFrames;
+        spans->second = firstFrames < frames ? buffer : nullptr;
+        spans->secondFrames = frames - firstFrames;
+    }
+
+    ma_uint64 getSlowestReadIndex() const {
+        ma_uint64 slowest = writeIndex.load(std::memory_order_relaxed);
+        for (auto& cursor : cursors)
+            slowest = std::min(slowest, cursor->readIndex.load(std::memory_order_acquire));
+        return slowest;
+    }
+
+public:
+    AudioBroadcastRing() = default;
+    ~AudioBroadcastRing() { uninit(); }
+
+    AudioBroadcastRing(const AudioBroadcastRing&) = delete;
+    AudioBroadcastRing& operator=(const AudioBroadcastRing&) = delete;
+
+    ma_result init(ma_uint32 bytesPerFrame, ma_uint32 frames, size_t subscriberCount, AudioFanoutPolicy fanoutPolicy) {
+        uninit();
+        if (bytesPerFrame == 0 || frames == 0 || frames > 0x20000000 || subscriberCount == 0)
+            return MA_INVALID_ARGS;
+
+        capacityFrames = 1;
+        while (capacityFrames < frames * 2) capacityFrames <<= 1;
+        limitFrames = frames;
+        mask = capacityFrames - 1;
+        frameSize = bytesPerFrame;
+        policy = fanoutPolicy;
+
+        buffer = (ma_uint8*)ma_aligned_malloc((size_t)capacityFrames * frameSize, SOUNDIO_CACHE_LINE_SIZE, nullptr);
+        if (buffer == nullptr) {
+            uninit();
+            return MA_OUT_OF_MEMORY;
+        }
+        memset(buffer, 0, (size_t)capacityFrames * frameSize);
+
+        for (size_t i = 0; i < subscriberCount; i++)
+            cursors.push_back(std::make_unique<Cursor>());
+        return MA_SUCCESS;
+    }
+
+    void uninit() {
+        if (buffer != nullptr) ma_aligned_free(buffer, nullptr);
+        buffer = nullptr;
+        cursors.clear();
+        capacityFrames = limitFrames = mask = frameSize = 0;
+        writeIndex.store(0, std::memory_order_relaxed);
+    }
+
+    bool isReady() const { return buffer != nullptr; }
+    size_t getSubscriberCount() const { return cursors.size(); }
+    ma_uint32 getCapacity() const { return limitFrames; }
+
+    // PRODUCER
+    ma_uint32 availableWrite() const {
+        if (!isReady()) return 0;
+        if (policy == AudioFanoutPolicy::DropSlowest) return limitFrames;
+        return limitFrames - (ma_uint32)(writeIndex.load(std::memory_order_relaxed) - getSlowestReadIndex());
+    }
+
+    ma_uint32 acquireWrite(ma_uint32 frames, AudioRingSpans* spans) {
+        *spans = AudioRingSpans();
+        if (!isReady()) return 0;
+
+        frames = std::min(frames, availableWrite());
+        fillSpans(writeIndex.load(std::memory_order_relaxed), frames, spans);
+        return frames;
+    }
+
+    void commitWrite(ma_uint32 frames) {
+        writeIndex.store(writeIndex.load(std::memory_order_relaxed) + frames, std::memory_order_release);
+    }
+
+    // CONSUMER (one thread per subscriber index)
+    ma_uint32 availableRead(size_t subscriber) const {
+        if (subscriber >= cursors.size()) return 0;
+        ma_uint64 pending = writeIndex.load(std::memory_order_acquire) - cursors[subscriber]->readIndex.load(std::memory_order_relaxed);
+        return (ma_uint32)std::min<ma_uint64>(pending, limitFrames);
+    }
+
+    ma_uint32 acquireRead(size_t subscriber, ma_uint32 frames, AudioRingSpans* spans) {
+        *spans = AudioRingSpans();
+        if (subscriber >= cursors.size()) return 0;
+
+        Cursor& cursor = *cursors[subscriber];
+        const ma_uint64 write = writeIndex.load(std::memory_order_acquire);
+        ma_uint64 read = cursor.readIndex.load(std::memory_order_relaxed);
+
+        // lapped, skip to the oldest frame still guaranteed intact
+        if (write - read > limitFrames) {
+            cursor.droppedFrames.fetch_add(write - read - limitFrames, std::memory_order_relaxed);
+            read = write - limitFrames;
+            cursor.readIndex.store(read, std::memory_order_release);
+        }
+
+        frames = (ma_uint32)std::min<ma_uint64>(frames, write - read);
+        fillSpans(read, frames, spans);
+        return frames;
+    }
+
+    // Returns false when the writer overwrote the acquired frames while they were being read
+    bool commitRead(size_t subscriber, ma_uint32 frames) {
+        if (subscriber >= cursors.size()) return false;
+
+        Cursor& cursor = *cursors[subscriber];
+        const ma_uint64 read = cursor.readIndex.load(std::memory_order_relaxed);
+        cursor.readIndex.store(read + frames, std::memory_order_release);
+
+        // the writer may be filling up to limitFrames past its committed index
+        const ma_uint64 write = writeIndex.load(std::memory_order_acquire);
+        if (write - read <= capacityFrames - limitFrames) return true;
+
+        cursor.droppedFrames.fetch_add(frames, std::memory_order_relaxed);
+        return false;
+    }
+
+    ma_uint64 getDroppedFrames(size_t subscriber) const {
+        return subscriber < cursors.size() ? cursors[subscriber]->droppedFrames.load(std::memory_order_relaxed) : 0;
+    }
+};
@@ -0,0 +1,176 @@
+#pragma once
+
+#include "../include.h"
+#include "./AudioFormat.h"
+#include "./AudioResampler.h"
+#include "../utils/simdconvert.h"
+
+// AudioConverter:
+// - Converts frames between two formats, used by endpoints for every format mismatch.
+// - When sample rates match and both sides are s16 / s32 / f32 with the same channel
+//   count, or mono <-> stereo, it runs the vectorized kernels of utils/simdconvert.h.
+// - Anything else (resampling, other formats or layouts) goes through ma_data_converter,
+//   resampling with the AudioResampleQuality tier it was initialized with.
+
+class AudioConverter {
+private:
+    static constexpr ma_uint32 chunkFrames = 256;
+
+    bool isInitialized = false;
+    bool isFast = false;
+    ma_data_converter converter{};
+    AudioFormat inputFormat;
+    AudioFormat outputFormat;
+
+    // f32 staging for multi-step conversions, 2 channels at most on the fast path
+    float toFloat[chunkFrames * 2];
+    float remapped[chunkFrames * 2];
+
+    static bool isFastFormat(ma_format format) {
+        return format == ma_format_s16 || format == ma_format_s32 || format == ma_format_f32;
+    }
+
+    static bool isFastLayout(ma_uint32 inputChannels, ma_uint32 outputChannels) {
+        if (inputChannels == outputChannels) return true;
+        return (inputChannels == 1 && outputChannels == 2) || (inputChannels == 2 && outputChannels == 1);
+    }
+
+    static void toF32(float* dst, const void* src, ma_format format, size_t samples) {
+        if (format == ma_format_s16) convertS16ToF32(dst, static_cast<const ma_int16*>(src), samples);
+        else if (format == ma_format_s32) convertS32ToF32(dst, static_cast<const ma_int32*>(src), samples);
+        else memcpy(dst, src, samples * sizeof(float));
+    }
+
+    static void fromF32(void* dst, const float* src, ma_format format, size_t samples) {
+        if (format == ma_format_s16) convertF32ToS16(static_cast<ma_int16*>(dst), src, samples);
+        else if (format == ma_format_s32) convertF32ToS32(static_cast<ma_int32*>(dst), src, samples);
+        else if (dst != src) memcpy(dst, src, samples * sizeof(float));
+    }
+
+    void processFast(const ma_uint8* in, ma_uint8* out, ma_uint32 frames) {
+        const ma_uint32 inChannels = inputFormat.channels;
+        const ma_uint32 outChannels = outputFormat.channels;
+
+        // same layout, format only: one kernel straight from in to out
+        if (inChannels == outChannels) {
+            const size_t samples = (size_t)frames * inChannels;
+            if (inputFormat.format == outputFormat.format) memcpy(out, in, inputFormat.frameSizeInBytes(frames));
+            else if (inputFormat.format == ma_format_f32) fromF32(out, reinterpret_cast<const float*>(in), outputFormat.format, samples);
+            else if (outputFormat.format == ma_format_f32) toF32(reinterpret_cast<float*>(out), in, inputFormat.format, samples);
+            else {
+                const ma_uint32 step = std::max<ma_uint32>(1, (chunkFrames * 2) / inChannels);
+                for (ma_uint32 offset = 0; offset < frames; offset += step) {
+                    const ma_uint32 n = std::min(step, frames - offset);
+                    toF32(toFloat, in + inputFormat.frameSizeInBytes(offset), inputFormat.format, (size_t)n * inChannels);
+                    fromF32(out + outputFormat.frameSizeInBytes(offset), toFloat, outputFormat.format, (size_t)n * outChannels);
+                }
+            }
+            return;
+        }
+
+        // mono <-> stereo, in f32
+        for (ma_uint32 offset = 0; offset < frames; offset += chunkFrames) {
+            const ma_uint32 n = std::min(chunkFrames, frames - offset);
+            const ma_uint8* source = in + inputFormat.frameSizeInBytes(offset);
+            ma_uint8* target = out + outputFormat.frameSizeInBytes(offset);
+
+            const float* samples = reinterpret_cast<const float*>(source);
+            if (inputFormat.format != ma_format_f32) {
+                toF32(toFloat, source, inputFormat.format, (size_t)n * inChannels);
+                samples = toFloat;
+            }
+
+            float* mixed = outputFormat.format == ma_format_f32 ? reinterpret_cast<float*>(target) : remapped;
+            if (inChannels == 1) convertMonoToStereoF32(mixed, samples, n);
+            else convertStereoToMonoF32(mixed, samples, n);
+
+            fromF32(target, mixed, outputFormat.format, (size_t)n * outChannels);
+        }
+    }
+
+public:
+    AudioConverter() = default;
+    ~AudioConverter() { uninit(); }
+
+    AudioConverter(const AudioConverter&) = delete;
+    AudioConverter& operator=(const AudioConverter&) = delete;
+
+    static bool canUseFastPath(const AudioFormat& from, const AudioFormat& to) {
+        return from.sampleRate == to.sampleRate
+            && isFastFormat(from.format) && isFastFormat(to.format)
+            && isFastLayout(from.channels, to.channels);
+    }
+
+    /// <summary>
+    /// Sets up a conversion from one format to another. quality picks the resampler when the rates differ.
+    /// </summary>
+    ma_result init(const AudioFormat& from, const AudioFormat& to, AudioResampleQuality quality = AudioResampleQuality::Linear) {
+        uninit();
+        inputFormat = from;
+        outputFormat = to;
+
+        isFast = canUseFastPath(from, to);
+        if (!isFast) {
+            ma_data_converter_config config = ma_data_converter_config_init(
+                from.toMaFormat(), to.toMaFormat(),
+                from.channels, to.channels,
+                from.sampleRate, to.sampleRate
+            );
+            AudioResampler::configure(config.resampling, quality);
+            ma_result result = ma_data_converter_init(&config, nullptr, &converter);
+            if (result != MA_SUCCESS) return result;
+        }
+
+        isInitialized = true;
+        return MA_SUCCESS;
+    }
+
+    void uninit() {
+        if (isInitialized && !isFast) ma_data_converter_uninit(&converter, nullptr);
+        isInitialized = false;
+        isFast = false;
+    }
+
+    bool isReady() const { return isInitialized; }
+    bool isFastPath() const { return isInitialized && isFast; }
+    const AudioFormat& getInputFormat() const { return inputFormat; }
+    const AudioFormat& getOutputFormat() const { return outputFormat; }
+
+    /// <summary>
+    /// Converts up to *inFrames input frames into at most *outFrames output frames.
+    /// Both are updated with what was consumed and produced.
+    /// </summary>
+    ma_result process(const void* in, ma_uint64* inFrames, void* out, ma_uint64* outFrames) {
+        if (!isInitialized) return MA_INVALID_OPERATION;
+        if (!isFast) return ma_data_converter_process_pcm_frames(&converter, in, inFrames, out, outFrames);
+
+        const ma_uint32 frames = (ma_uint32)std::min(*inFrames, *outFrames);
+        processFast(static_cast<const ma_uint8*>(in), static_cast<ma_uint8*>(out), frames);
+        *inFrames = *outFrames = frames;
+        return MA_SUCCESS;
+    }
+
+    // Output frames for inputFrames, resamplers may emit one extra frame depending on their phase
+    ma_uint64 getExpectedOutputFrames(ma_uint64 inputFrames) {
+        if (!isInitialized || isFast) return inputFrames;
+
+        ma_uint64 outputFrames = 0;
+        if (ma_data_converter_get_expected_output_frame_count(&converter, inputFrames, &outputFrames) != MA_SUCCESS)
+            return inputFrames;
+        return outputFrames + 1;
+    }
+
+    // Input frames held back by the resampler, 0 without one
+    ma_uint64 getInputLatency() const {
+        if (!isInitialized || isFast) return 0;
+        return ma_data_converter_get_input_latency(&converter);
+    }
+
+    ma_uint64 getRequiredInputFrames(ma_uint64 outputFrames) {
+        if (!isInitialized || isFast) return outputFrames;
+
+        ma_uint64 inputFrames = outputFrames;
+        ma_data_converter_get_required_input_frame_count(&converter, outputFrames, &inputFrames);
+        return inputFrames;
+    }
+};
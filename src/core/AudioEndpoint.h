@@ -2,6 +2,12 @@
 
 #include "./AudioNode.h"
 #include "./AudioFormat.h"
+#include "./AudioScratch.h"
+#include "./AudioConverter.h"
+#include "./AudioRing.h"
+#include "./AudioBroadcast.h"
+#include "./AudioLatency.h"
+#include "./AudioStats.h"
 
 // INPUT  node v
 // MIX    self v (SUBMIT DEFINED BY NODE ITSELF)
@@ -11,32 +17,266 @@
 // - Always stores PCM in self format inside its FIFOs.
 // - Input FIFO: holds data from upstream (converted to self format).
 // - Output FIFO: holds data ready to be consumed by downstream.
-// - Converters rebuilt on renegotiation.
+// - Converters rebuilt on renegotiation (AudioConverter), same-rate conversions between
+//   s16/s32/f32 and mono/stereo run on SIMD kernels, the rest goes through ma_data_converter.
+// - Rings, converters, links and scratch form a Pipeline. Renegotiation builds a new one
+//   next to the live one and swaps it in atomically, callbacks pick it up at their next
+//   block and the old one is freed once no callback holds it.
 // - mixPCM() is fixed pipeline; handleMixPCM() is the hook.
+// - Scratch arenas are sized on renegotiation, the callback path never allocates.
+// - Links are resolved to typed endpoints on renegotiation, the callback path does no RTTI.
+// - With several outputs the output FIFO becomes a broadcast ring in self format,
+//   each output reads with its own cursor (and converter if its format differs).
+//   Only the primary output clocks the producer (whenOutputSubmitted).
+// - In adaptive latency mode the output FIFO is sized for maxLatencyMS and the producer is
+//   held to a target that follows the consumer's callback jitter (AudioLatencyController),
+//   every adjustment is logged for getLatencyAdjustments(). Fanned-out nodes stay fixed.
+// - Dropped frames, short reads, FIFO fill ranges and renegotiations are counted with
+//   relaxed atomics (getStats(), SoundIO::collectStats()).
+// - With latencyMarkerFrames set, sources stamp a timestamp every N frames next to their
+//   output FIFO; each consumer takes the markers its reads went past and re-attaches them
+//   to what it writes next, up to a sink that measures the end-to-end latency.
+// - Nodes that can render in blocks are scheduled by their sink's AudioGraph instead,
+//   every link or format change rebuilds the graphs (notifyTopologyChanged()).
+// - Sources with an end (files) report it once drained, nodes downstream once all their
+//   inputs have and their FIFOs are empty (isEndOfStream(), used by AudioOfflineRenderer).
 
 class AudioEndpoint : public virtual AudioNode {
     friend class AudioDevice;
     friend class AudioFile;
+    friend class AudioGraph;
+    friend class AudioCombiner;
+    friend class AudioOfflineRenderer;
 
 protected:
     bool canFillInputRing = false;
     bool canDrainOutputRing = false;
 
-    bool hasInputToSelfConverter = false;
-    ma_data_converter inputToSelfConverter{};
-    bool hasSelfToOutputConverter = false;
-    ma_data_converter selfToOutputConverter{};
-    bool areConvertersReady = false;
+    bool isNegociationDone = false;
 
-    ma_pcm_rb inputRing{};
-    ma_pcm_rb outputRing{};
-    ma_uint32 inputRingFrames = 0;
-    ma_uint32 outputRingFrames = 0;
+    // Format of the frames this node writes to its output FIFO, when it differs from its own (processing nodes)
+    bool hasProducedFormat = false;
+    AudioFormat producedFormat;
+    const AudioFormat& getProducedFormat() const { return hasProducedFormat ? producedFormat : audioFormat; }
+
+    struct FanoutSubscriber {
+        AudioNode* node = nullptr;
+        bool hasConverter = false;
+        AudioConverter converter;
+    };
+
+    std::atomic<ma_uint64> callbackAllocations{ 0 };
+    AudioEndpointCounters stats;
+
+    // Marker taken from upstream, attached to the next frames this node outputs (audio thread)
+    AudioLatencyMarker pendingMarker;
+    bool hasPendingMarker = false;
+
+    // Latency telemetry, kept across renegotiations
+    std::atomic<ma_uint64> latencyCallbacks{ 0 };
+    std::atomic<ma_uint64> latencyUnderruns{ 0 };
+    std::atomic<ma_uint64> latencyAdjustments{ 0 };
+    AudioFrameRing latencyLog; // consumer -> getLatencyAdjustments()
+    const ma_uint64 latencyOriginId = AudioLatencyPaths::makeOriginId(); // markers this node stamps
+
+    // Node specific state the callbacks read through the pipeline (mixing sources, decoders),
+    // built by preparePipeline() and freed with the pipeline once no callback holds it
+    struct PipelineState {
+        virtual ~PipelineState() = default;
+    };
+
+    // Everything the callback path uses that a renegotiation rebuilds
+    struct Pipeline {
+        std::atomic<ma_uint32> users{ 0 };   // callbacks processing a block with it
+        std::atomic<ma_uint32> writers{ 0 }; // producers between acquireWrite() and commitWrite()
+
+        // Typed links, resolved on renegotiation so callbacks never need RTTI
+        AudioEndpoint* inputEndpoint = nullptr;
+        AudioEndpoint* outputEndpoint = nullptr;
+
+        AudioFormat selfFormat;     // blocks read from the input, once converted
+        AudioFormat producedFormat; // blocks rendered, before the conversion to the output
+
+        bool hasInputToSelfConverter = false;
+        AudioConverter inputToSelfConverter;
+        bool hasSelfToOutputConverter = false;
+        AudioConverter selfToOutputConverter;
+        bool areConvertersReady = false;
+
+        AudioRing inputRing;
+        AudioRing outputRing;
+        ma_uint32 inputRingFrames = 0;
+        ma_uint32 outputRingFrames = 0;
+
+        AudioFormat inputRingFormat;
+        AudioFormat outputRingFormat;
+
+        bool isBroadcasting = false;
+        AudioBroadcastRing outputBroadcast;
+        std::vector<std::unique_ptr<FanoutSubscriber>> fanoutSubscribers;
+
+        AudioScratch receiveScratch; // input -> self conversion
+        AudioScratch mixScratch;     // input ring drain
+        AudioScratch convertScratch; // self -> output conversion
+        AudioScratch sourceScratch;  // source nodes (decoders, generators)
+
+        AudioLatencyController latency; // output FIFO target, consumer side
+
+        // latency markers along the output FIFO, positions in frames written / read
+        AudioFrameRing markers;
+        ma_uint64 markerWritten = 0; // producer
+        ma_uint64 markerRead = 0;    // primary consumer
+        ma_int64 framesToMarker = 0; // sources, until the next one is due
+
+        std::unique_ptr<PipelineState> state;
+
+        explicit Pipeline(std::atomic<ma_uint64>* allocations)
+            : receiveScratch(allocations), mixScratch(allocations),
+              convertScratch(allocations), sourceScratch(allocations) {}
+
+        // Frees everything, only once no callback uses this pipeline
+        void release() {
+            inputEndpoint = outputEndpoint = nullptr;
+            selfFormat = producedFormat = AudioFormat();
+
+            inputToSelfConverter.uninit();
+            selfToOutputConverter.uninit();
+            hasInputToSelfConverter = hasSelfToOutputConverter = areConvertersReady = false;
+
+            inputRing.uninit();
+            outputRing.uninit();
+            outputBroadcast.uninit();
+            inputRingFrames = outputRingFrames = 0;
+            inputRingFormat = outputRingFormat = AudioFormat();
+
+            isBroadcasting = false;
+            fanoutSubscribers.clear();
+
+            markers.uninit();
+            markerWritten = markerRead = 0;
+            framesToMarker = 0;
+
+            receiveScratch.release();
+            mixScratch.release();
+            convertScratch.release();
+            sourceScratch.release();
+
+            state.reset();
+        }
+    };
+
+    // A pipeline held by the calling thread for the block it is processing
+    struct PipelineLease {
+        const AudioEndpoint* owner = nullptr;
+        Pipeline* pipeline = nullptr;
+        PipelineLease* previous = nullptr;
+    };
+    static inline thread_local PipelineLease* leases = nullptr;
+
+    // Set while an AudioOfflineRenderer drives this thread: no device deadline to meet, sources
+    // fed by a background thread wait for it instead of padding with silence
+    static inline thread_local bool isRenderingOffline = false;
+
+    // Leases the published pipeline for the scope. Nested scopes on the same endpoint
+    // (hooks, mixPCM() from whenInputSubmitted()) keep the outer one, so a swap is only
+    // picked up at the next block.
+    class PipelineScope {
+    private:
+        PipelineLease lease;
+        bool isOwner = false;
+
+        void push(AudioEndpoint* endpoint, Pipeline* target) {
+            lease.owner = endpoint;
+            lease.pipeline = target;
+            lease.previous = leases;
+            leases = &lease;
+            isOwner = true;
+        }
 
-    AudioFormat inputRingFormat;
-    AudioFormat outputRingFormat;
+    public:
+        explicit PipelineScope(AudioEndpoint* endpoint) {
+            if (endpoint->findLease() == nullptr)
+                push(endpoint, endpoint->acquirePipeline());
+        }
 
-    bool isNegociationDone = false;
+        ~PipelineScope() {
+            if (!isOwner) return;
+            leases = lease.previous;
+            lease.pipeline->users.fetch_sub(1);
+        }
+
+        PipelineScope(const PipelineScope&) = delete;
+        PipelineScope& operator=(const PipelineScope&) = delete;
+    };
+
+    // Double-buffered: renegotiation builds the standby one then swaps it in. One swapped out
+    // while a producer still writes through its spans is parked until that producer commits,
+    // and a fresh standby takes its place (renegotiateMutex).
+    std::unique_ptr<Pipeline> activePipeline = std::make_unique<Pipeline>(&callbackAllocations);
+    std::unique_ptr<Pipeline> standbyPipeline;
+    std::vector<std::unique_ptr<Pipeline>> parkedPipelines;
+    std::atomic<Pipeline*> pipeline{ activePipeline.get() };
+    std::mutex renegotiateMutex;
+    std::atomic<bool> isRenegotiationRequested{ false };
+
+    const PipelineLease* findLease() const {
+        for (const PipelineLease* lease = leases; lease != nullptr; lease = lease->previous)
+            if (lease->owner == this) return lease;
+        return nullptr;
+    }
+
+    Pipeline* acquirePipeline() {
+        while (true) {
+            Pipeline* current = pipeline.load();
+            current->users.fetch_add(1);
+            if (pipeline.load() == current) return current;
+            current->users.fetch_sub(1); // swapped meanwhile
+        }
+    }
+
+    // Pipeline leased by this thread, or the published one (renegotiating thread)
+    Pipeline& current() const {
+        const PipelineLease* lease = findLease();
+        return lease ? *lease->pipeline : *pipeline.load();
+    }
+
+    // Released standby to build into, reclaiming parked pipelines nobody holds anymore
+    Pipeline* takeStandby() {
+        for (auto it = parkedPipelines.begin(); it != parkedPipelines.end();) {
+            if ((*it)->writers.load() != 0 || (*it)->users.load() != 0) { ++it; continue; }
+            if (!standbyPipeline) standbyPipeline = std::move(*it);
+            it = parkedPipelines.erase(it);
+        }
+        if (!standbyPipeline) standbyPipeline = std::make_unique<Pipeline>(&callbackAllocations);
+
+        standbyPipeline->release();
+        return standbyPipeline.get();
+    }
+
+    // Swaps the standby in, waits for the callbacks still using the old one then frees it.
+    // Write leases are not waited for: they span API calls, possibly on this very thread.
+    // Neither is a scope held by this thread (renegotiating from a hook of this node), the
+    // old pipeline is parked until a later renegotiation finds it unused.
+    void publishStandby() {
+        Pipeline* old = pipeline.exchange(standbyPipeline.get());
+        std::swap(activePipeline, standbyPipeline);
+
+        const PipelineLease* lease = findLease();
+        if (lease != nullptr && lease->pipeline == old) {
+            parkedPipelines.push_back(std::move(standbyPipeline));
+            return;
+        }
+
+        // callbacks hold it for one block at most, back off once that is clearly exceeded
+        for (int spins = 0; old->users.load() != 0; spins++) {
+            if (spins < 64) std::this_thread::yield();
+            else std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+
+        // writers only grow while a user holds the pipeline, so this is final
+        if (old->writers.load() != 0) parkedPipelines.push_back(std::move(standbyPipeline));
+        else old->release();
+    }
 
     AudioFormat* getInputFormat() {
         return !inputNode ? nullptr : &inputNode->audioFormat;
@@ -45,99 +285,116 @@ protected:
         return !outputNode ? nullptr : &outputNode->audioFormat;
     }
 
+    void resolveLinks(Pipeline& target) {
+        target.inputEndpoint = dynamic_cast<AudioEndpoint*>(inputNode);
+        target.outputEndpoint = dynamic_cast<AudioEndpoint*>(outputNode);
+    }
+
     ma_uint32 pullFromEndpoint(void* pOut, ma_uint32 frames) {
-        if (auto ep = dynamic_cast<AudioEndpoint*>(inputNode))
-            return ep->submitPCM(pOut, frames);
-        return 0;
+        PipelineScope scope(this);
+        AudioEndpoint* input = current().inputEndpoint;
+        return input ? input->submitPCM(pOut, frames, this) : 0;
     }
 
     void pushToEndpoint(const void* pData, ma_uint32 frames) {
-        if (auto ep = dynamic_cast<AudioEndpoint*>(outputNode))
-            ep->receivePCM(pData, frames);
+        PipelineScope scope(this);
+        AudioEndpoint* output = current().outputEndpoint;
+        if (output) output->receivePCM(pData, frames);
     }
 
-    ma_result buildConverters() {
-        this->areConvertersReady = false;
-
-        if (hasInputToSelfConverter) {
-            ma_data_converter_uninit(&inputToSelfConverter, nullptr);
-            hasInputToSelfConverter = false;
-        }
-        if (hasSelfToOutputConverter) {
-            ma_data_converter_uninit(&selfToOutputConverter, nullptr);
-            hasSelfToOutputConverter = false;
+    ma_result buildConverters(Pipeline& target) {
+        target.areConvertersReady = false;
+        target.isBroadcasting = canDrainOutputRing && isFannedOut();
+        target.selfFormat = audioFormat;
+        target.producedFormat = getProducedFormat();
 
-        }
-        
         auto* inputFormat = getInputFormat();
         auto* outputFormat = getOutputFormat();
-        if (hasSelfToOutputConverter)
-            printf("Converter enabled: %uHz → %uHz\n", audioFormat.sampleRate, outputFormat->sampleRate);
 
         ma_result result = MA_SUCCESS;
 
         // I -> SELF
         if (inputFormat != nullptr && audioFormat != *inputFormat) {
-            ma_data_converter_config config = ma_data_converter_config_init(
-                inputFormat->toMaFormat(),
-                audioFormat.toMaFormat(),
-                inputFormat->channels,
-                audioFormat.channels,
-                inputFormat->sampleRate,
-                audioFormat.sampleRate
-            );
-            result = ma_data_converter_init(&config, nullptr, &inputToSelfConverter);
-            hasInputToSelfConverter = result == MA_SUCCESS;
+            result = target.inputToSelfConverter.init(*inputFormat, audioFormat, resampleQuality);
+            target.hasInputToSelfConverter = result == MA_SUCCESS;
         }
         if (result != MA_SUCCESS) return result;
 
-        // SELF -> O
-        if (outputFormat != nullptr) {
-            ma_data_converter_config config = ma_data_converter_config_init(
-                audioFormat.toMaFormat(),
-                outputFormat->toMaFormat(),
-                audioFormat.channels,
-                outputFormat->channels,
-                audioFormat.sampleRate,
-                outputFormat->sampleRate
-            );
-            result = ma_data_converter_init(&config, nullptr, &selfToOutputConverter);
-            hasSelfToOutputConverter = result == MA_SUCCESS;
+        // SELF -> every O, converted on read
+        const AudioFormat& selfFormat = getProducedFormat();
+        if (target.isBroadcasting) {
+            for (AudioNode* node : outputNodes) {
+                auto subscriber = std::make_unique<FanoutSubscriber>();
+                subscriber->node = node;
+
+                if (node->audioFormat != selfFormat) {
+                    result = subscriber->converter.init(selfFormat, node->audioFormat, resampleQuality);
+                    subscriber->hasConverter = result == MA_SUCCESS;
+                    if (result != MA_SUCCESS) return result;
+                }
+
+                target.fanoutSubscribers.push_back(std::move(subscriber));
+            }
+        }
+
+        // SELF -> O, skipped when formats already match (passthrough)
+        else if (outputFormat != nullptr && selfFormat != *outputFormat) {
+            result = target.selfToOutputConverter.init(selfFormat, *outputFormat, resampleQuality);
+            target.hasSelfToOutputConverter = result == MA_SUCCESS;
         }
         if (result != MA_SUCCESS) return result;
 
-        this->areConvertersReady = hasInputToSelfConverter || hasSelfToOutputConverter;
+        target.areConvertersReady = target.hasInputToSelfConverter || target.hasSelfToOutputConverter || target.isBroadcasting;
         return result;
     }
 
-    ma_result initializeRings(ma_uint32 inputFrames, ma_uint32 outputFrames) {
+    ma_uint64 getExpectedOutputFrames(AudioConverter* converter, bool hasConverter, ma_uint32 inputFrames) {
+        return hasConverter ? converter->getExpectedOutputFrames(inputFrames) : inputFrames;
+    }
+
+    // Sizes every arena for the largest block a callback can see with the target's rings
+    void reserveScratch(Pipeline& target) {
+        const ma_uint32 selfFrameSize = std::max(audioFormat.frameSizeInBytes(), getProducedFormat().frameSizeInBytes());
+        const ma_uint32 inputFrameSize = std::max(selfFrameSize, target.inputRingFormat.frameSizeInBytes());
+        const ma_uint32 outputFrameSize = std::max(selfFrameSize, target.outputRingFormat.frameSizeInBytes());
+        const ma_uint32 blockFrames = std::max(target.inputRingFrames, target.outputRingFrames);
+
+        target.receiveScratch.reserve(selfFrameSize *
+            getExpectedOutputFrames(&target.inputToSelfConverter, target.hasInputToSelfConverter, blockFrames));
+        target.mixScratch.reserve((size_t)inputFrameSize * target.inputRingFrames);
+        target.convertScratch.reserve(outputFrameSize *
+            getExpectedOutputFrames(&target.selfToOutputConverter, target.hasSelfToOutputConverter, target.inputRingFrames));
+        target.sourceScratch.reserve((size_t)outputFrameSize * blockFrames);
+    }
+
+    ma_result initializeRings(Pipeline& target, ma_uint32 inputFrames, ma_uint32 outputFrames) {
         auto* inFmt = getInputFormat();
         auto* outFmt = getOutputFormat();
 
-        inputRingFrames = inputFrames;
-        outputRingFrames = outputFrames;
+        target.inputRingFrames = inputFrames;
+        target.outputRingFrames = outputFrames;
 
         ma_result result = MA_SUCCESS;
 
         if (canFillInputRing) {
-            inputRingFormat = inFmt ? *inFmt : audioFormat;
-            result = ma_pcm_rb_init(
-                inputRingFormat.toMaFormat(),
-                inputRingFormat.channels,
-                inputRingFrames,
-                nullptr, nullptr, &inputRing
-            );
+            target.inputRingFormat = inFmt ? *inFmt : audioFormat;
+            result = target.inputRing.init(target.inputRingFormat, target.inputRingFrames, ringBackend);
             if (result != MA_SUCCESS) return result;
         }
 
         if (canDrainOutputRing) {
-            outputRingFormat = outFmt ? *outFmt : audioFormat;
-            result = ma_pcm_rb_init(
-                outputRingFormat.toMaFormat(),
-                outputRingFormat.channels,
-                outputRingFrames,
-                nullptr, nullptr, &outputRing
-            );
+            result = target.markers.init(sizeof(AudioLatencyMarker), 64);
+            if (result != MA_SUCCESS) return result;
+        }
+
+        if (canDrainOutputRing && target.isBroadcasting) {
+            target.outputRingFormat = getProducedFormat();
+            result = target.outputBroadcast.init(target.outputRingFormat.frameSizeInBytes(), target.outputRingFrames, outputNodes.size(), fanoutPolicy);
+            if (result != MA_SUCCESS) return result;
+        }
+        else if (canDrainOutputRing) {
+            target.outputRingFormat = outFmt ? *outFmt : getProducedFormat();
+            result = target.outputRing.init(target.outputRingFormat, target.outputRingFrames, ringBackend);
             if (result != MA_SUCCESS) return result;
         }
 
@@ -145,42 +402,239 @@ protected:
     }
 
     // Write to a ring buffer using acquire/commit
-    void writeRing(ma_pcm_rb& rb, const AudioFormat& fmt, const void* pData, ma_uint32 frames) {
-        if (fmt.sampleRate == 0) return;
+    template <typename TRing>
+    ma_uint32 writeRing(TRing& ring, const AudioFormat& fmt, const void* pData, ma_uint32 frames) {
+        if (fmt.sampleRate == 0) return 0;
 
         ma_uint32 framesToWrite = frames;
         while (framesToWrite > 0) {
-            void* pDst = nullptr;
-            ma_uint32 writable = framesToWrite;
-            if (ma_pcm_rb_acquire_write(&rb, &writable, &pDst) != MA_SUCCESS || writable == 0) break;
+            AudioRingSpans spans;
+            ma_uint32 writable = ring.acquireWrite(framesToWrite, &spans);
+            if (writable == 0) break;
 
-            memcpy(pDst, pData, fmt.frameSizeInBytes(writable));
-            ma_pcm_rb_commit_write(&rb, writable);
+            memcpy(spans.first, pData, fmt.frameSizeInBytes(spans.firstFrames));
+            if (spans.secondFrames > 0)
+                memcpy(spans.second, (const ma_uint8*)pData + fmt.frameSizeInBytes(spans.firstFrames), fmt.frameSizeInBytes(spans.secondFrames));
+            ring.commitWrite(writable);
 
             framesToWrite -= writable;
             pData = (const ma_uint8*)pData + fmt.frameSizeInBytes(writable);
         }
+        stats.countDropped(framesToWrite);
+        return frames - framesToWrite;
     }
 
     // Read from a ring buffer using acquire/commit
-    ma_uint32 readRing(ma_pcm_rb& rb, const AudioFormat& fmt, void* pOut, ma_uint32 frames) {
+    ma_uint32 readRing(AudioRing& ring, const AudioFormat& fmt, void* pOut, ma_uint32 frames) {
         if (pOut == nullptr || fmt.sampleRate == 0) return 0;
         ma_uint32 totalRead = 0;
         ma_uint32 framesToRead = frames;
 
         while (framesToRead > 0) {
-            void* pSrc = nullptr;
-
-            ma_uint32 readable = framesToRead;
-            if (ma_pcm_rb_acquire_read(&rb, &readable, &pSrc) != MA_SUCCESS || readable == 0) break;
+            AudioRingSpans spans;
+            ma_uint32 readable = ring.acquireRead(framesToRead, &spans);
+            if (readable == 0) break;
 
-            memcpy(pOut, pSrc, fmt.frameSizeInBytes(readable));
-            ma_pcm_rb_commit_read(&rb, readable);
+            memcpy(pOut, spans.first, fmt.frameSizeInBytes(spans.firstFrames));
+            if (spans.secondFrames > 0)
+                memcpy((ma_uint8*)pOut + fmt.frameSizeInBytes(spans.firstFrames), spans.second, fmt.frameSizeInBytes(spans.secondFrames));
+            ring.commitRead(readable);
 
             totalRead += readable;
             framesToRead -= readable;
             pOut = (ma_uint8*)pOut + fmt.frameSizeInBytes(readable);
         }
+        stats.countRead(frames, totalRead);
+        return totalRead;
+    }
+
+    // Frames the producer may still queue before reaching the latency target
+    ma_uint32 getOutputHeadroom(Pipeline& p) {
+        if (!p.latency.isAdaptive()) return UINT32_MAX;
+        const ma_uint32 fill = p.outputRing.availableRead();
+        const ma_uint32 target = p.latency.getTargetFrames();
+        return target > fill ? target - fill : 0;
+    }
+
+    // Capture / submission delay of a source before its frames reach the output FIFO
+    virtual double getSourceDelaySeconds() const { return 0.0; }
+
+    static ma_int64 getMarkerClock() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Producer side, frames were just output: sources stamp a new marker every latencyMarkerFrames,
+    // others pass on what they took from upstream. marker.position is the offset in the block.
+    bool takeOutputMarker(Pipeline& p, ma_uint32 frames, AudioLatencyMarker& marker) {
+        if (inputNode == nullptr && latencyMarkerFrames > 0 && frames > 0) {
+            const ma_int64 offset = p.framesToMarker;
+            p.framesToMarker -= frames;
+            if (offset < (ma_int64)frames) {
+                // one marker per block at most
+                p.framesToMarker = std::max<ma_int64>(p.framesToMarker + latencyMarkerFrames, 0);
+
+                marker.origin = this;
+                marker.originId = latencyOriginId;
+                marker.timeNs = getMarkerClock() - (ma_int64)(getSourceDelaySeconds() * 1e9);
+                marker.position = (ma_uint64)offset;
+                return true;
+            }
+        }
+
+        if (!hasPendingMarker) return false;
+        marker = pendingMarker;
+        marker.position = 0;
+        hasPendingMarker = false;
+        return true;
+    }
+
+    void stampOutput(Pipeline& p, ma_uint32 written) {
+        AudioLatencyMarker marker;
+        if (takeOutputMarker(p, written, marker) && p.markers.getCapacity() > 0) {
+            marker.position += p.markerWritten;
+            p.markers.write(&marker, 1); // dropped when full, markers are sparse
+        }
+        p.markerWritten += written;
+    }
+
+    // Consumer side: hands the markers this read went past to the reading endpoint
+    void passMarkers(Pipeline& p, AudioEndpoint* reader, ma_uint32 read) {
+        p.markerRead += read;
+        if (p.markers.getCapacity() == 0) return;
+
+        AudioRingSpans spans;
+        while (p.markers.acquireRead(1, &spans) == 1) {
+            AudioLatencyMarker marker;
+            memcpy(&marker, spans.first, sizeof(marker));
+            if (marker.position >= p.markerRead) break;
+
+            p.markers.commitRead(1);
+            if (reader == nullptr) continue;
+            reader->pendingMarker = marker;
+            reader->hasPendingMarker = true;
+        }
+    }
+
+    // Graph path, the step rendered frames without going through its FIFO
+    void forwardMarker(Pipeline& p, ma_uint32 frames) {
+        AudioLatencyMarker marker;
+        if (!takeOutputMarker(p, frames, marker) || p.outputEndpoint == nullptr) return;
+        p.outputEndpoint->pendingMarker = marker;
+        p.outputEndpoint->hasPendingMarker = true;
+    }
+
+    // Frames the output has yet to read. Fanned out, that is the primary output's backlog: it
+    // clocks the producer, side subscribers lag behind or skip ahead on their own cursors.
+    ma_uint32 getOutputFill(Pipeline& p) {
+        return p.isBroadcasting ? p.outputBroadcast.availableRead(0) : p.outputRing.availableRead();
+    }
+
+    void reportConsumed(Pipeline& p, ma_uint32 requested, ma_uint32 read, ma_uint32 fillBefore) {
+        AudioLatencyEvent event;
+        p.latency.onConsume(requested, read, fillBefore, event);
+
+        latencyCallbacks.fetch_add(1, std::memory_order_relaxed);
+        if (event.isUnderrun) latencyUnderruns.fetch_add(1, std::memory_order_relaxed);
+        if (!event.isAdjusted) return;
+
+        latencyAdjustments.fetch_add(1, std::memory_order_relaxed);
+        latencyLog.write(&event.adjustment, 1); // dropped when nobody drains the log
+    }
+
+    // Output FIFO, routed to the broadcast ring when fanned out.
+    // acquire / commit must run under the same PipelineScope.
+    ma_uint32 acquireOutputWrite(ma_uint32 frames, AudioRingSpans* spans) {
+        Pipeline& p = current();
+        if (p.isBroadcasting) return p.outputBroadcast.acquireWrite(frames, spans);
+        return p.outputRing.acquireWrite(std::min(frames, getOutputHeadroom(p)), spans);
+    }
+
+    void commitOutputWrite(ma_uint32 frames) {
+        Pipeline& p = current();
+        if (p.isBroadcasting) p.outputBroadcast.commitWrite(frames);
+        else p.outputRing.commitWrite(frames);
+        stampOutput(p, frames);
+        stats.outputFill.track(getOutputFill(p));
+    }
+
+    ma_uint32 getOutputAvailableWrite() {
+        PipelineScope scope(this);
+        Pipeline& p = current();
+        if (p.isBroadcasting) return p.outputBroadcast.availableWrite();
+        return std::min(p.outputRing.availableWrite(), getOutputHeadroom(p));
+    }
+
+    void writeOutputRing(const void* pData, ma_uint32 frames) {
+        PipelineScope scope(this);
+        Pipeline& p = current();
+        ma_uint32 written = 0;
+        if (p.isBroadcasting) written = writeRing(p.outputBroadcast, p.outputRingFormat, pData, frames);
+        else {
+            const ma_uint32 allowed = std::min(frames, getOutputHeadroom(p));
+            written = writeRing(p.outputRing, p.outputRingFormat, pData, allowed);
+            stats.countDropped(frames - allowed);
+        }
+        stampOutput(p, written);
+        stats.outputFill.track(getOutputFill(p));
+    }
+
+    // Broadcast cursor of a consumer in this pipeline, fanoutSubscribers.size() when it isn't one.
+    // Resolved from the pipeline, outputNodes changes on the user thread before the next one is published.
+    static size_t findSubscriber(const Pipeline& p, const AudioNode* consumer) {
+        for (size_t i = 0; i < p.fanoutSubscribers.size(); i++)
+            if (p.fanoutSubscribers[i]->node == consumer) return i;
+        return p.fanoutSubscribers.size();
+    }
+
+    // Copies (or converts) broadcast frames straight from ring memory into the subscriber's buffer
+    ma_uint32 readBroadcast(Pipeline& p, size_t index, void* pOut, ma_uint32 frames) {
+        if (pOut == nullptr || index >= p.fanoutSubscribers.size()) return 0;
+
+        FanoutSubscriber& subscriber = *p.fanoutSubscribers[index];
+        const AudioFormat& targetFormat = subscriber.node->audioFormat;
+        ma_uint32 totalRead = 0;
+
+        while (totalRead < frames) {
+            ma_uint64 wanted = frames - totalRead;
+            if (subscriber.hasConverter)
+                wanted = subscriber.converter.getRequiredInputFrames(wanted);
+
+            AudioRingSpans spans;
+            if (p.outputBroadcast.acquireRead(index, (ma_uint32)wanted, &spans) == 0) break;
+
+            ma_uint8* pBlock = (ma_uint8*)pOut + targetFormat.frameSizeInBytes(totalRead);
+            ma_uint32 consumed = 0;
+            ma_uint32 produced = 0;
+
+            void* regions[2] = { spans.first, spans.second };
+            ma_uint32 regionFrames[2] = { spans.firstFrames, spans.secondFrames };
+            for (int i = 0; i < 2 && regionFrames[i] > 0; i++) {
+                if (!subscriber.hasConverter) {
+                    memcpy(pBlock + targetFormat.frameSizeInBytes(produced), regions[i], p.outputRingFormat.frameSizeInBytes(regionFrames[i]));
+                    consumed += regionFrames[i];
+                    produced += regionFrames[i];
+                    continue;
+                }
+
+                ma_uint64 inF = regionFrames[i];
+                ma_uint64 outF = frames - totalRead - produced;
+                subscriber.converter.process(
+                    regions[i], &inF,
+                    pBlock + targetFormat.frameSizeInBytes(produced), &outF);
+                consumed += (ma_uint32)inF;
+                produced += (ma_uint32)outF;
+                if (inF < regionFrames[i]) break;
+            }
+
+            // lapped while copying, what was read is unreliable
+            if (!p.outputBroadcast.commitRead(index, consumed))
+                ma_silence_pcm_frames(pBlock, produced, targetFormat.format, targetFormat.channels);
+
+            totalRead += produced;
+            if (produced == 0) break;
+        }
+        stats.countRead(frames, totalRead);
         return totalRead;
     }
 
@@ -188,26 +642,50 @@ protected:
     void receivePCM(const void* pData, ma_uint32 frameCount) {
         if (!canFillInputRing) return;
 
-        if (hasInputToSelfConverter) {
+        PipelineScope scope(this);
+        Pipeline& p = current();
+        if (p.hasInputToSelfConverter) {
             const AudioFormat& outFmt = audioFormat; // converter output format
-            std::vector<uint8_t> temp(outFmt.frameSizeInBytes(frameCount));
-            ma_uint64 inF = frameCount, outF = frameCount;
-            ma_data_converter_process_pcm_frames(&inputToSelfConverter,
+            ma_uint64 inF = frameCount;
+            ma_uint64 outF = getExpectedOutputFrames(&p.inputToSelfConverter, true, frameCount);
+            void* temp = p.receiveScratch.acquire(outFmt.frameSizeInBytes((ma_uint32)outF));
+            p.inputToSelfConverter.process(
                 pData, &inF,
-                temp.data(), &outF);
-            writeRing(inputRing, inputRingFormat, temp.data(), (ma_uint32)outF);
+                temp, &outF);
+            writeRing(p.inputRing, p.inputRingFormat, temp, (ma_uint32)outF);
         }
         else {
-            writeRing(inputRing, inputRingFormat, pData, frameCount);
+            writeRing(p.inputRing, p.inputRingFormat, pData, frameCount);
         }
+        stats.inputFill.track(p.inputRing.availableRead());
         whenInputSubmitted(pData, frameCount);
     }
 
     // SELF -> OUTPUT
-    ma_uint32 submitPCM(void* pOut, ma_uint32 frameCount) {
+    ma_uint32 submitPCM(void* pOut, ma_uint32 frameCount, AudioNode* consumer = nullptr) {
         if (!canDrainOutputRing) return 0;
-        ma_uint32 read = readRing(outputRing, outputRingFormat, pOut, frameCount);
-        whenOutputSubmitted(pOut, frameCount);
+
+        PipelineScope scope(this);
+        Pipeline& p = current();
+        if (isRenderingOffline) awaitOutputFrames(frameCount);
+
+        if (!p.isBroadcasting) {
+            const ma_uint32 fill = p.outputRing.availableRead();
+            stats.outputFill.track(fill);
+            ma_uint32 read = readRing(p.outputRing, p.outputRingFormat, pOut, frameCount);
+            reportConsumed(p, frameCount, read, fill);
+            passMarkers(p, consumer == p.outputEndpoint ? p.outputEndpoint : nullptr, read);
+            whenOutputSubmitted(pOut, frameCount);
+            return read;
+        }
+
+        // the first subscriber is the primary output
+        const size_t index = findSubscriber(p, consumer);
+        ma_uint32 read = readBroadcast(p, index, pOut, frameCount);
+        if (index == 0) {
+            passMarkers(p, p.outputEndpoint, read);
+            whenOutputSubmitted(pOut, frameCount);
+        }
         return read;
     }
 
@@ -216,69 +694,181 @@ protected:
         if (!canFillInputRing || !canDrainOutputRing)
             return MA_INVALID_OPERATION;
 
-        ma_uint32 available = ma_pcm_rb_available_read(&inputRing);
+        PipelineScope scope(this);
+        Pipeline& p = current();
+        ma_uint32 available = p.inputRing.availableRead();
+        stats.inputFill.track(available);
         if (available == 0)
             return MA_NO_DATA_AVAILABLE;
 
-        std::vector<uint8_t> temp(audioFormat.frameSizeInBytes(available));
-        readRing(inputRing, inputRingFormat, temp.data(), available);
+        // passthrough, frames move from ring to ring without a staging copy
+        if (!p.hasSelfToOutputConverter && p.inputRingFormat == p.outputRingFormat) {
+            while (available > 0) {
+                AudioRingSpans spans;
+                ma_uint32 readable = p.inputRing.acquireRead(available, &spans);
+                if (readable == 0) break;
+
+                writeOutputRing(spans.first, spans.firstFrames);
+                if (spans.secondFrames > 0)
+                    writeOutputRing(spans.second, spans.secondFrames);
+                p.inputRing.commitRead(readable);
+                available -= readable;
+            }
+            return handleMixPCM(MA_SUCCESS);
+        }
+
+        void* temp = p.mixScratch.acquire(
+            std::max(audioFormat.frameSizeInBytes(available), p.inputRingFormat.frameSizeInBytes(available)));
+        readRing(p.inputRing, p.inputRingFormat, temp, available);
 
-        if (hasSelfToOutputConverter) {
+        if (p.hasSelfToOutputConverter) {
             ma_uint64 inF = available;
-            ma_uint64 outF = 0;
-            ma_data_converter_get_expected_output_frame_count(
-                &selfToOutputConverter, inF, &outF);
-
-            // allocate for outputRingFormat, not audioFormat
-            std::vector<uint8_t> converted(
-                outputRingFormat.frameSizeInBytes((ma_uint32)outF));
-
-            ma_result res = ma_data_converter_process_pcm_frames(
-                &selfToOutputConverter,
-                temp.data(), &inF,
-                converted.data(), &outF);
+            ma_uint64 outF = getExpectedOutputFrames(&p.selfToOutputConverter, true, available);
+
+            // sized for outputRingFormat, not audioFormat
+            void* converted = p.convertScratch.acquire(
+                p.outputRingFormat.frameSizeInBytes((ma_uint32)outF));
+
+            ma_result res = p.selfToOutputConverter.process(
+                temp, &inF,
+                converted, &outF);
             if (res != MA_SUCCESS) return res;
 
-            writeRing(outputRing, outputRingFormat, converted.data(), (ma_uint32)outF);
+            writeOutputRing(converted, (ma_uint32)outF);
         }
 
-        else writeRing(outputRing, outputRingFormat, temp.data(), available);
+        else writeOutputRing(temp, available);
         return handleMixPCM(MA_SUCCESS);
     }
 
-    ma_uint32 getRingAvailableRead(ma_pcm_rb* ring) { return ma_pcm_rb_available_read(ring); }
-    ma_uint32 getRingAvailableWrite(ma_pcm_rb* ring) { return ma_pcm_rb_available_write(ring); }
+    ma_uint32 getRingAvailableRead(AudioRing* ring) { return ring->availableRead(); }
+    ma_uint32 getRingAvailableWrite(AudioRing* ring) { return ring->availableWrite(); }
 
     ma_result handleInputSubscribe(AudioNode*) override { renegotiate(); return MA_SUCCESS; }
     ma_result handleOutputSubscribe(AudioNode*) override { renegotiate(); return MA_SUCCESS; }
     ma_result handleInputUnsubscribe(AudioNode*) override { renegotiate(); return MA_SUCCESS; }
     ma_result handleOutputUnsubscribe(AudioNode*) override { renegotiate(); return MA_SUCCESS; }
 
+    // Graph rendering (see AudioGraph)
+    // inputs follow collectGraphInputs() as it was when the plan was built, each names its node
+    // and holds a block already in this node's format, or nullptr when that input is not
+    // scheduled and must be pulled from its ring. pOut receives frames in the produced format.
+    struct GraphInput {
+        AudioNode* node = nullptr;
+        const void* block = nullptr;
+    };
+    virtual bool isGraphRenderable() const { return false; }
+    // True when renderGraphBlock() works with pOut aliasing inputs[0].block, so the graph can share one buffer
+    virtual bool canRenderInPlace() const { return false; }
+    virtual void collectGraphInputs(std::vector<AudioNode*>& inputs) { if (inputNode) inputs.push_back(inputNode); }
+    virtual void renderGraphBlock(const GraphInput* inputs, size_t inputCount, void* pOut, ma_uint32 frames) { (void)inputs; (void)inputCount; (void)pOut; (void)frames; }
+
+    void notifyTopologyChanged();
+
+    // End of stream: tailFrames is how many frames of the last block rendered were real,
+    // the rest was silence padding. Live sources (streams, devices) never end.
+    virtual bool checkEndOfStream(ma_uint32& tailFrames) {
+        PipelineScope scope(this);
+        return isInputEndOfStream(tailFrames) && !hasBufferedFrames(current());
+    }
+
+    bool isInputEndOfStream(ma_uint32& tailFrames) {
+        AudioEndpoint* input = current().inputEndpoint;
+        return input != nullptr && input->checkEndOfStream(tailFrames);
+    }
+
+    // Frames still waiting in this node's FIFOs, for the primary output when fanned out
+    bool hasBufferedFrames(Pipeline& p) {
+        if (canFillInputRing && p.inputRing.availableRead() > 0) return true;
+        return canDrainOutputRing && getOutputFill(p) > 0;
+    }
+
+    // A block rendered offline in this node's format, only sinks that can store it implement this
+    virtual ma_result consumeRenderedBlock(const void* pData, ma_uint32 frames) { (void)pData; (void)frames; return MA_NOT_IMPLEMENTED; }
+
     virtual ma_result handleMixPCM(ma_result prevResult) { (void)prevResult; return MA_SUCCESS; }
     virtual void whenInputSubmitted(const void* pData, ma_uint32 frameCount) {}
     virtual void whenOutputSubmitted(void* pOut, ma_uint32 frameCount) {}
+    virtual void awaitOutputFrames(ma_uint32 frameCount) { (void)frameCount; } // offline reads only, until frameCount frames are ready or the source ended
     virtual void whenRenegotiated() {}
-     
+    virtual void preparePipeline(Pipeline& target) { (void)target; } // standby pipeline, before its converters are built
+    virtual void whenPipelineReady() {} // after a successful renegotiation, the new pipeline is live
+
+    // Output FIFO length outside adaptive latency mode
+    virtual ma_uint32 getOutputBufferMS() const { return bufferSafetyMS; }
+
+    // Starts from the previous target when it was adaptive already, bufferSafetyMS otherwise
+    void configureLatency(Pipeline& target, bool isAdaptive, ma_uint32 sampleRate, ma_uint32 capacityFrames) {
+        const AudioLatencyController& previous = pipeline.load()->latency;
+        ma_uint64 initialMS = bufferSafetyMS;
+        if (previous.isAdaptive() && previous.getSampleRate() > 0)
+            initialMS = (ma_uint64)previous.getTargetFrames() * 1000 / previous.getSampleRate();
+
+        const ma_uint32 minFrames = (ma_uint32)(((ma_uint64)sampleRate * minLatencyMS) / 1000);
+        target.latency.configure(isAdaptive, sampleRate, minFrames, capacityFrames,
+            (ma_uint32)(((ma_uint64)sampleRate * initialMS) / 1000));
+
+        if (isAdaptive && latencyLog.getCapacity() == 0)
+            latencyLog.init(sizeof(AudioLatencyAdjustment), 256);
+    }
+
+    // Builds links, converters and rings into the standby pipeline while callbacks keep
+    // running on the active one, then swaps. Meant for the user thread: from a hook of this
+    // node the old pipeline is only freed by a later renegotiation, and when another thread is
+    // already renegotiating (and waiting for this thread's scope) it is asked to run again.
     void renegotiate() {
+        std::unique_lock<std::mutex> lock(renegotiateMutex, std::defer_lock);
+        if (findLease() == nullptr) lock.lock();
+        else {
+            isRenegotiationRequested.store(true);
+            if (!lock.try_lock()) return; // the holder sees the request once it unlocks
+        }
+
+        while (true) {
+            isRenegotiationRequested.store(false);
+            rebuildPipeline();
+            lock.unlock();
+
+            // requested while we held the lock, by a thread that could not wait for it
+            if (!isRenegotiationRequested.load() || !lock.try_lock()) return;
+        }
+    }
+
+    void rebuildPipeline() {
+        stats.renegotiations.fetch_add(1, std::memory_order_relaxed);
+
         this->isNegociationDone = false;
         this->whenRenegotiated();
 
+        Pipeline* next = takeStandby();
+        preparePipeline(*next);
+        resolveLinks(*next);
+
         // Rebuild converters
-        ma_result result = buildConverters();
-        if (result != MA_SUCCESS) {
-            this->isNegociationDone = false;
-            return;
-        }
+        ma_result result = buildConverters(*next);
 
         // Rebuild rings using connected formats
-        auto* inFmt = getInputFormat();
-        auto* outFmt = getOutputFormat();
+        if (result == MA_SUCCESS) {
+            auto* inFmt = getInputFormat();
+            auto* outFmt = getOutputFormat();
 
-        ma_uint32 inputFrames = ((inFmt ? inFmt->sampleRate : audioFormat.sampleRate) * bufferSafetyMS) / 1000;
-        ma_uint32 outputFrames = ((outFmt ? outFmt->sampleRate : audioFormat.sampleRate) * bufferSafetyMS) / 1000;
+            const ma_uint32 outputRate = outFmt ? outFmt->sampleRate : audioFormat.sampleRate;
+            const bool isAdaptive = latencyMode == AudioLatencyMode::Adaptive && canDrainOutputRing && !next->isBroadcasting;
 
-        result = initializeRings(inputFrames, outputFrames);
+            ma_uint32 inputFrames = ((inFmt ? inFmt->sampleRate : audioFormat.sampleRate) * bufferSafetyMS) / 1000;
+            ma_uint32 outputFrames = (outputRate * (isAdaptive ? std::max(maxLatencyMS, minLatencyMS) : getOutputBufferMS())) / 1000;
+
+            result = initializeRings(*next, inputFrames, outputFrames);
+            if (result == MA_SUCCESS) configureLatency(*next, isAdaptive, outputRate, outputFrames);
+        }
+
+        if (result == MA_SUCCESS) reserveScratch(*next);
+        else next->release(); // callbacks see an idle endpoint rather than stale links
+
+        publishStandby();
         this->isNegociationDone = result == MA_SUCCESS;
+        if (result == MA_SUCCESS) this->whenPipelineReady();
+        notifyTopologyChanged();
     }
 
 public:
@@ -288,13 +878,111 @@ public:
     /// </summary>
     ma_uint32 bufferSafetyMS = 50;
 
-    ma_uint32 getInputRingFrames() const { return inputRingFrames; }
-    ma_uint32 getOutputRingFrames() const { return outputRingFrames; }
+    /// <summary>
+    /// Ring buffer implementation used for this endpoint's FIFOs.
+    /// Default is miniaudio's ma_pcm_rb, applied on the next renegotiation.
+    /// </summary>
+    AudioRingBackend ringBackend = AudioRingBackend::Miniaudio;
+
+    /// <summary>
+    /// What to drop when one of several outputs cannot keep up.
+    /// Default drops the late output's oldest frames so the others are never held back.
+    /// </summary>
+    AudioFanoutPolicy fanoutPolicy = AudioFanoutPolicy::DropSlowest;
+
+    /// <summary>
+    /// Resampler for every rate change this endpoint makes (its converters, file decoders), applied on the next renegotiation.
+    /// Default is Linear, the cheapest. Sinc is clean enough for music in realtime, Offline is for renders.
+    /// </summary>
+    AudioResampleQuality resampleQuality = AudioResampleQuality::Linear;
+
+    /// <summary>
+    /// Output FIFO sizing, applied on the next renegotiation.
+    /// Adaptive runs the lowest latency that stays free of underruns between minLatencyMS and maxLatencyMS,
+    /// starting from bufferSafetyMS. Fixed (default) always uses bufferSafetyMS.
+    /// </summary>
+    AudioLatencyMode latencyMode = AudioLatencyMode::Fixed;
+    ma_uint32 minLatencyMS = 5;
+    ma_uint32 maxLatencyMS = 200;
 
-    virtual ~AudioEndpoint() {
-        if (hasInputToSelfConverter) ma_data_converter_uninit(&inputToSelfConverter, nullptr);
-        if (hasSelfToOutputConverter) ma_data_converter_uninit(&selfToOutputConverter, nullptr);
-        ma_pcm_rb_uninit(&inputRing);
-        ma_pcm_rb_uninit(&outputRing);
+    /// <summary>
+    /// Sources only: stamps a latency marker every N output frames, 0 (default) stamps none.
+    /// Sinks that measure latency report it per source (AudioSpeakerDevice::getPathLatencies()).
+    /// </summary>
+    ma_uint32 latencyMarkerFrames = 0;
+
+    /// <summary>
+    /// Current latency state of the output FIFO and counters since creation, safe from any thread.
+    /// </summary>
+    AudioLatencyTelemetry getLatencyTelemetry() {
+        PipelineScope scope(this);
+        Pipeline& p = current();
+
+        AudioLatencyTelemetry telemetry;
+        telemetry.mode = p.latency.isAdaptive() ? AudioLatencyMode::Adaptive : AudioLatencyMode::Fixed;
+        telemetry.capacityFrames = p.outputRingFrames;
+        telemetry.targetFrames = p.latency.isAdaptive() ? p.latency.getTargetFrames() : p.outputRingFrames;
+        telemetry.lastFillFrames = p.latency.getLastFill();
+        telemetry.targetMS = p.outputRingFormat.sampleRate ? telemetry.targetFrames * 1000.0f / p.outputRingFormat.sampleRate : 0.0f;
+        telemetry.callbackIntervalMS = p.latency.getIntervalMS();
+        telemetry.callbackJitterMS = p.latency.getJitterMS();
+        telemetry.callbacks = latencyCallbacks.load(std::memory_order_relaxed);
+        telemetry.underruns = latencyUnderruns.load(std::memory_order_relaxed);
+        telemetry.adjustments = latencyAdjustments.load(std::memory_order_relaxed);
+        return telemetry;
     }
+
+    /// <summary>
+    /// Moves the adjustments made since the last call into out, oldest first.
+    /// Up to 256 wait between calls, later ones are only counted. Call from one thread.
+    /// </summary>
+    /// <returns>Number of adjustments appended</returns>
+    size_t getLatencyAdjustments(std::vector<AudioLatencyAdjustment>& out) {
+        size_t count = 0;
+        AudioLatencyAdjustment adjustment;
+        while (latencyLog.getCapacity() > 0 && latencyLog.read(&adjustment, 1) == 1) {
+            out.push_back(adjustment);
+            count++;
+        }
+        return count;
+    }
+
+    /// <summary>
+    /// Glitch counters and FIFO fill ranges, safe from any thread and never blocks the audio thread.
+    /// </summary>
+    /// <param name="resetFill">Starts a new fill range window after reading it</param>
+    AudioEndpointStats getStats(bool resetFill = false) {
+        PipelineScope scope(this);
+        Pipeline& p = current();
+
+        AudioEndpointStats out;
+        out.node = this;
+        stats.snapshot(out, resetFill);
+        out.inputCapacity = canFillInputRing ? p.inputRingFrames : 0;
+        out.outputCapacity = canDrainOutputRing ? p.outputRingFrames : 0;
+        return out;
+    }
+
+    /// <summary>
+    /// True once everything upstream ran out and was drained (file inputs past their end).
+    /// Always false with a live source (stream input, microphone) upstream.
+    /// </summary>
+    bool isEndOfStream() {
+        ma_uint32 tailFrames = 0;
+        return checkEndOfStream(tailFrames);
+    }
+
+    ma_uint32 getInputRingFrames() const { return pipeline.load()->inputRingFrames; }
+    ma_uint32 getOutputRingFrames() const { return pipeline.load()->outputRingFrames; }
+
+    /// <summary>
+    /// Number of times a scratch arena had to grow from the audio callback path.
+    /// Stays at 0 in steady state; any increase means a callback hit the heap.
+    /// </summary>
+    ma_uint64 getCallbackAllocations() const { return callbackAllocations.load(std::memory_order_relaxed); }
+
+    virtual ~AudioEndpoint() { AudioLatencyPaths::forgetOrigin(latencyOriginId); }
 };
+
+// AudioEndpoint::notifyTopologyChanged is defined with AudioGraph
+#include "./AudioGraph.h"
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../core/AudioStream.h"
+#include "../core/AudioFileStream.h"
 #include "../include.h"
 
 static const std::unordered_map<std::string, ma_encoding_format> extToFormat = {
@@ -17,8 +18,16 @@ protected:
     bool hasDecoder = false;
     bool hasEncoder = false;
     std::string filePath;
+
+    // Where the encoded file lives: filePath on disk, filePath through fileVFS, or fileData in memory.
+    // A stream source is filePath (a name hint) through streamVFS.
+    ma_vfs* fileVFS = nullptr;
+    const void* fileData = nullptr;
+    size_t fileDataBytes = 0;
+    std::shared_ptr<AudioFileStream> fileStream;
+    AudioStreamVFS streamVFS;
     
-    bool isInputFinished;
+    std::atomic<bool> isInputFinished; // set by whichever thread decodes
 
     ma_encoding_format encodingFormat = ma_encoding_format_unknown;
 
@@ -50,30 +59,108 @@ protected:
         return ma_encoding_format_unknown;
     }
 
-    ma_result openFileDecode(const std::string& path) {
+    void setSource(const std::string& path, ma_vfs* vfs = nullptr) {
+        clearSource();
+        filePath = path;
+        fileVFS = vfs;
+    }
+
+    void setSource(const void* pData, size_t bytes) {
+        clearSource();
+        fileData = pData;
+        fileDataBytes = bytes;
+    }
+
+    // name only hints the encoding through its extension
+    void setSource(std::shared_ptr<AudioFileStream> stream, const std::string& name) {
+        clearSource();
+        fileStream = std::move(stream);
+        streamVFS.setStream(fileStream.get());
+        filePath = name.empty() ? "stream" : name; // miniaudio wants a path to open
+        fileVFS = streamVFS.get();
+    }
+
+    void clearSource() {
+        filePath.clear();
+        encodingFormat = ma_encoding_format_unknown;
+        fileVFS = nullptr;
+        fileData = nullptr;
+        fileDataBytes = 0;
+        streamVFS.setStream(nullptr);
+        fileStream.reset();
+    }
+
+    // A plain file on disk (what can be mapped or cached by path)
+    bool isPathSource() const { return !filePath.empty() && fileVFS == nullptr && fileData == nullptr; }
+
+    ma_result initDecoder(const ma_decoder_config* config, ma_decoder* target) {
+        if (fileData != nullptr) return ma_decoder_init_memory(fileData, fileDataBytes, config, target);
+        if (filePath.empty()) return MA_INVALID_ARGS;
+        if (fileVFS != nullptr) return ma_decoder_init_vfs(fileVFS, filePath.c_str(), config, target);
+        return ma_decoder_init_file(filePath.c_str(), config, target);
+    }
+
+    ma_result initEncoder(const ma_encoder_config* config, ma_encoder* target) {
+        if (fileData != nullptr || filePath.empty()) return MA_INVALID_ARGS; // memory is read-only, encode into an AudioMemoryStream
+        if (fileVFS != nullptr) return ma_encoder_init_vfs(fileVFS, filePath.c_str(), config, target);
+        return ma_encoder_init_file(filePath.c_str(), config, target);
+    }
+
+    // Which built-in backend a decoder picked, unknown for custom ones
+    static ma_encoding_format getDecoderEncoding(const ma_decoder& target) {
+#if defined(MA_HAS_WAV)
+        if (target.pBackendVTable == &g_ma_decoding_backend_vtable_wav) return ma_encoding_format_wav;
+#endif
+#if defined(MA_HAS_FLAC)
+        if (target.pBackendVTable == &g_ma_decoding_backend_vtable_flac) return ma_encoding_format_flac;
+#endif
+#if defined(MA_HAS_MP3)
+        if (target.pBackendVTable == &g_ma_decoding_backend_vtable_mp3) return ma_encoding_format_mp3;
+#endif
+        return ma_encoding_format_unknown;
+    }
+
+    // Probes the source's native format, keepOpen keeps the decoder for reading (no negotiation)
+    ma_result probeDecoder(bool keepOpen = false) {
+        if (keepOpen) closeDecoder();
+
         ma_decoder temporaryDecoder;
-        ma_result result = ma_decoder_init_file(path.c_str(), NULL, &temporaryDecoder);
+        ma_decoder* target = keepOpen ? &decoder : &temporaryDecoder;
+        ma_result result = initDecoder(NULL, target);
 
         if (result == MA_SUCCESS) {
-            filePath = path;
             audioFormat = AudioFormat(
-                temporaryDecoder.outputFormat,
-                temporaryDecoder.outputChannels,
-                temporaryDecoder.outputSampleRate
+                target->outputFormat,
+                target->outputChannels,
+                target->outputSampleRate
             );
-            encodingFormat = ma_encoding_format_unknown;
+            encodingFormat = getDecoderEncoding(*target);
+
+            if (keepOpen) hasDecoder = true;
+            else ma_decoder_uninit(target);
         }
+        else clearSource();
 
-        ma_decoder_uninit(&temporaryDecoder);
         return result;
     }
 
+    ma_result openFileDecode(const std::string& path, bool keepOpen = false) {
+        setSource(path);
+        return probeDecoder(keepOpen);
+    }
+
+    // Checks the file can be written in targetFormat, keepOpen keeps the encoder for writing (no negotiation)
     ma_result openFileEncode(
         const std::string& path,
         const AudioFormat& targetFormat,
-        ma_encoding_format targetEncodingFormat = ma_encoding_format_unknown
+        ma_encoding_format targetEncodingFormat = ma_encoding_format_unknown,
+        bool keepOpen = false
     ) {
+        if (keepOpen) closeEncoder();
+        setSource(path);
+
         ma_encoder temporaryEncoder;
+        ma_encoder* target = keepOpen ? &encoder : &temporaryEncoder;
 
         ma_encoder_config encoderConfig = ma_encoder_config_init(
             guessEncodingFormat(path, targetEncodingFormat),
@@ -82,22 +169,21 @@ protected:
             targetFormat.sampleRate
         );
 
-        ma_result result = ma_encoder_init_file(path.c_str(), &encoderConfig, &temporaryEncoder);
+        ma_result result = initEncoder(&encoderConfig, target);
         if (result == MA_SUCCESS) {
-            filePath = path;
             audioFormat = targetFormat;
             encodingFormat = encoderConfig.encodingFormat;
+
+            if (keepOpen) hasEncoder = true;
+            else ma_encoder_uninit(target);
         }
-        
-        ma_encoder_uninit(&temporaryEncoder);
+        else clearSource();
+
         return result;
     }
 
-    ma_result openDecoder() {
-        closeDecoder();
-        bufferStatus = MA_SUCCESS;
-        isInputFinished = false;
-
+    // Decoder in the consumer's format into target, from the source or from a file already in memory
+    ma_result initOutputDecoder(ma_decoder* target, const void* pFileData = nullptr, size_t fileBytes = 0) {
         if (!this->isOutputSubscribed()) return MA_NOT_CONNECTED;
 
         auto* outputFormat = this->getOutputFormat();
@@ -106,8 +192,19 @@ protected:
             outputFormat->channels, 
             outputFormat->sampleRate
         );
+        AudioResampler::configure(config.resampling, this->resampleQuality);
+
+        return pFileData != nullptr
+            ? ma_decoder_init_memory(pFileData, fileBytes, &config, target)
+            : initDecoder(&config, target);
+    }
+
+    // Decoder in the consumer's format, from the source or from a file already in memory
+    ma_result openDecoder(const void* pFileData = nullptr, size_t fileBytes = 0) {
+        closeDecoder();
 
-        ma_result result = ma_decoder_init_file(filePath.c_str(), &config, &decoder);
+        ma_result result = initOutputDecoder(&decoder, pFileData, fileBytes);
+        if (result == MA_NOT_CONNECTED) return result;
         if (result == MA_SUCCESS) {
             hasDecoder = true;
 
@@ -120,9 +217,9 @@ protected:
         return result;
     }
 
-    ma_result openEncoder(const std::string& path, const AudioFormat& targetFormat, ma_encoding_format encodingFormat) {
+    // Encoder on the source set beforehand
+    ma_result openEncoder(const AudioFormat& targetFormat, ma_encoding_format encodingFormat) {
         closeEncoder();
-        bufferStatus = MA_SUCCESS;
         audioFormat = targetFormat;
 
         ma_encoder_config config = ma_encoder_config_init(
@@ -132,10 +229,10 @@ protected:
             audioFormat.sampleRate
         );
 
-        ma_result result = ma_encoder_init_file(path.c_str(), &config, &encoder);
+        ma_result result = initEncoder(&config, &encoder);
         if (result == MA_SUCCESS) {
             hasEncoder = true;
-            filePath = path;
+            this->encodingFormat = config.encodingFormat;
             renegotiate(); 
         }
 
@@ -147,7 +244,6 @@ protected:
         if (hasDecoder) {
             ma_decoder_uninit(&decoder);
             hasDecoder = false;
-            filePath.clear();
         }
 
         bufferStatus = MA_SUCCESS;
@@ -158,7 +254,6 @@ protected:
         if (hasEncoder) {
             ma_encoder_uninit(&encoder);
             hasEncoder = false;
-            filePath.clear();
         }
         bufferStatus = MA_SUCCESS;
     }
@@ -169,11 +264,17 @@ protected:
             return MA_NO_DEVICE;
         }
 
+        return readFromDecoder(&decoder, pData, frameCount, framesRead);
+    }
+
+    // Reads a decoder opened on this file's source (its own, or one a subclass keeps)
+    ma_result readFromDecoder(ma_decoder* source, void* pData, ma_uint32 frameCount, ma_uint32* framesRead) {
         ma_uint64 framesRead64;
-        ma_result result = ma_decoder_read_pcm_frames(&decoder, pData, frameCount, &framesRead64);
+        ma_result result = ma_decoder_read_pcm_frames(source, pData, frameCount, &framesRead64);
         *framesRead = (ma_uint32)framesRead64;
 
-        if (result == MA_SUCCESS && *framesRead == 0)
+        // the decoder only stops short at the end, and reports MA_AT_END once nothing is left
+        if ((result == MA_SUCCESS || result == MA_AT_END) && *framesRead < frameCount)
             isInputFinished = true;
 
         bufferStatus = result;
@@ -198,6 +299,7 @@ public:
     const std::string& getFilePath() const { return filePath; }
     ma_result getBufferStatus() const { return bufferStatus; }
     const AudioFormat& getFormat() const { return audioFormat; }
+    ma_encoding_format getEncodingFormat() const { return encodingFormat; }
 
     virtual ~AudioFile() {
         closeDecoder();
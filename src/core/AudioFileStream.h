@@ -0,0 +1,187 @@
+#pragma once
+
+#include "../include.h"
+
+// AudioFileStream:
+// - Byte stream a file endpoint decodes from or encodes into instead of a path: an archive entry,
+//   a network buffer, anything that can read (or write), seek and tell.
+// - Calls come from whichever thread decodes or encodes (a callback, the decode-ahead or writer
+//   thread), one at a time. The stream is rewound before every decoder is opened on it.
+// - Encoders need write and seek: WAV headers are patched once the data length is known.
+
+class AudioFileStream {
+public:
+    virtual ~AudioFileStream() = default;
+
+    virtual ma_result read(void* pDst, size_t bytes, size_t* bytesRead) {
+        (void)pDst; (void)bytes;
+        *bytesRead = 0;
+        return MA_NOT_IMPLEMENTED;
+    }
+
+    virtual ma_result write(const void* pSrc, size_t bytes, size_t* bytesWritten) {
+        (void)pSrc; (void)bytes;
+        *bytesWritten = 0;
+        return MA_NOT_IMPLEMENTED;
+    }
+
+    virtual ma_result seek(ma_int64 offset, ma_seek_origin origin) = 0;
+    virtual ma_result tell(ma_int64* cursor) = 0;
+
+    /// <summary>
+    /// Total size in bytes, MA_NOT_IMPLEMENTED when unknown (some decoders then can't report a length).
+    /// </summary>
+    virtual ma_result getSize(ma_uint64* bytes) {
+        *bytes = 0;
+        return MA_NOT_IMPLEMENTED;
+    }
+};
+
+// AudioMemoryStream:
+// - Read-only view of bytes someone else keeps alive (nothing is copied), or a growable buffer
+//   an encoder writes a whole file into.
+
+class AudioMemoryStream : public AudioFileStream {
+private:
+    const ma_uint8* view = nullptr; // read-only mode
+    size_t viewSize = 0;
+    std::vector<ma_uint8> buffer;   // writable mode
+    size_t cursor = 0;
+
+    const ma_uint8* data() const { return view ? view : buffer.data(); }
+    size_t size() const { return view ? viewSize : buffer.size(); }
+
+public:
+    /// <summary>
+    /// An empty buffer to encode into.
+    /// </summary>
+    AudioMemoryStream() = default;
+
+    /// <summary>
+    /// Reads bytes at pData, which must outlive the stream.
+    /// </summary>
+    AudioMemoryStream(const void* pData, size_t bytes) : view((const ma_uint8*)pData), viewSize(bytes) {}
+
+    ma_result read(void* pDst, size_t bytes, size_t* bytesRead) override {
+        const size_t available = cursor < size() ? size() - cursor : 0;
+        *bytesRead = std::min(bytes, available);
+        if (*bytesRead > 0) memcpy(pDst, data() + cursor, *bytesRead);
+        cursor += *bytesRead;
+        return *bytesRead == 0 && bytes > 0 ? MA_AT_END : MA_SUCCESS;
+    }
+
+    ma_result write(const void* pSrc, size_t bytes, size_t* bytesWritten) override {
+        *bytesWritten = 0;
+        if (view != nullptr) return MA_ACCESS_DENIED;
+
+        if (cursor + bytes > buffer.size()) buffer.resize(cursor + bytes);
+        memcpy(buffer.data() + cursor, pSrc, bytes);
+        cursor += bytes;
+        *bytesWritten = bytes;
+        return MA_SUCCESS;
+    }
+
+    ma_result seek(ma_int64 offset, ma_seek_origin origin) override {
+        ma_int64 base = 0;
+        if (origin == ma_seek_origin_current) base = (ma_int64)cursor;
+        else if (origin == ma_seek_origin_end) base = (ma_int64)size();
+
+        const ma_int64 position = base + offset;
+        if (position < 0 || (view != nullptr && position > (ma_int64)viewSize)) return MA_BAD_SEEK;
+        cursor = (size_t)position; // writes past the end grow the buffer
+        return MA_SUCCESS;
+    }
+
+    ma_result tell(ma_int64* position) override {
+        *position = (ma_int64)cursor;
+        return MA_SUCCESS;
+    }
+
+    ma_result getSize(ma_uint64* bytes) override {
+        *bytes = size();
+        return MA_SUCCESS;
+    }
+
+    bool isReadOnly() const { return view != nullptr; }
+
+    /// <summary>
+    /// What was encoded so far. Complete once the output writing it was closed.
+    /// </summary>
+    const std::vector<ma_uint8>& getBuffer() const { return buffer; }
+
+    /// <summary>
+    /// Moves the encoded bytes out, the stream starts over empty.
+    /// </summary>
+    std::vector<ma_uint8> takeBuffer() {
+        cursor = 0;
+        return std::move(buffer);
+    }
+};
+
+// AudioStreamVFS:
+// - Presents one AudioFileStream as a miniaudio VFS, so ma_decoder_init_vfs / ma_encoder_init_vfs
+//   drive it: decoders get read, seek and tell, encoders write and seek. Every path opens the stream.
+
+class AudioStreamVFS {
+private:
+    ma_vfs_callbacks callbacks; // first member, miniaudio casts the ma_vfs* back to it
+    AudioFileStream* stream = nullptr;
+
+    static AudioFileStream* toStream(ma_vfs_file file) { return (AudioFileStream*)file; }
+
+    static ma_result onOpen(ma_vfs* pVFS, const char*, ma_uint32, ma_vfs_file* pFile) {
+        AudioFileStream* stream = ((AudioStreamVFS*)pVFS)->stream;
+        *pFile = nullptr;
+        if (stream == nullptr) return MA_DOES_NOT_EXIST;
+
+        // decoders probe from the first byte
+        ma_result result = stream->seek(0, ma_seek_origin_start);
+        if (result != MA_SUCCESS) return result;
+        *pFile = (ma_vfs_file)stream;
+        return MA_SUCCESS;
+    }
+
+    static ma_result onOpenW(ma_vfs* pVFS, const wchar_t*, ma_uint32 openMode, ma_vfs_file* pFile) {
+        return onOpen(pVFS, nullptr, openMode, pFile);
+    }
+
+    static ma_result onClose(ma_vfs*, ma_vfs_file) { return MA_SUCCESS; } // the endpoint owns the stream
+
+    static ma_result onRead(ma_vfs*, ma_vfs_file file, void* pDst, size_t bytes, size_t* bytesRead) {
+        return toStream(file)->read(pDst, bytes, bytesRead);
+    }
+
+    static ma_result onWrite(ma_vfs*, ma_vfs_file file, const void* pSrc, size_t bytes, size_t* bytesWritten) {
+        return toStream(file)->write(pSrc, bytes, bytesWritten);
+    }
+
+    static ma_result onSeek(ma_vfs*, ma_vfs_file file, ma_int64 offset, ma_seek_origin origin) {
+        return toStream(file)->seek(offset, origin);
+    }
+
+    static ma_result onTell(ma_vfs*, ma_vfs_file file, ma_int64* cursor) {
+        return toStream(file)->tell(cursor);
+    }
+
+    static ma_result onInfo(ma_vfs*, ma_vfs_file file, ma_file_info* pInfo) {
+        return toStream(file)->getSize(&pInfo->sizeInBytes);
+    }
+
+public:
+    AudioStreamVFS() {
+        callbacks.onOpen = onOpen;
+        callbacks.onOpenW = onOpenW;
+        callbacks.onClose = onClose;
+        callbacks.onRead = onRead;
+        callbacks.onWrite = onWrite;
+        callbacks.onSeek = onSeek;
+        callbacks.onTell = onTell;
+        callbacks.onInfo = onInfo;
+    }
+
+    AudioStreamVFS(const AudioStreamVFS&) = delete;
+    AudioStreamVFS& operator=(const AudioStreamVFS&) = delete;
+
+    void setStream(AudioFileStream* target) { stream = target; }
+    ma_vfs* get() { return (ma_vfs*)this; }
+};
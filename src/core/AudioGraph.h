@@ -0,0 +1,255 @@
+#pragma once
+
+#include "../include.h"
+#include "./AudioEndpoint.h"
+
+// AudioGraph:
+// - Render schedule of the nodes feeding one sink (a speaker), rebuilt off the audio
+//   thread whenever a link or a format changes anywhere (rebuildAll()).
+// - Nodes upstream of the sink running at its sample rate are sorted once, sources first,
+//   and rendered in that order every device period into reusable block buffers:
+//   one pass per period, no ring between two scheduled nodes. Adjacent nodes sharing
+//   one format render in place in a single buffer.
+// - A node stays on the ring path when it is fanned out, runs at another rate or can't
+//   render in blocks (stream inputs, microphones), the scheduled node reading it pulls
+//   from its ring like before.
+// - Plans are swapped atomically, the old plan is freed once the callback let go of it.
+
+class AudioGraph {
+private:
+    struct Step {
+        AudioEndpoint* node = nullptr;
+        std::vector<AudioEndpoint::GraphInput> inputs; // block nullptr = pulled from the input's ring
+        std::vector<ma_uint8> block;      // produced format, unused when sharing the input's buffer
+        std::vector<ma_uint8> converted;  // consumer format, when it differs
+        void* output = nullptr;           // block, or the input's buffer when rendering in place
+        bool converts = false;
+
+        // what the buffers were sized for, the node's live pipeline must still match
+        AudioFormat self;
+        AudioFormat produced;
+        AudioFormat consumer;
+
+        const void* getOutput() const { return converts ? converted.data() : output; }
+    };
+
+    struct Plan {
+        std::vector<std::unique_ptr<Step>> steps; // sources first, the sink's input last
+        ma_uint32 blockFrames = 0;
+        AudioFormat sinkFormat;
+        ma_uint32 sinkFrameSize = 0;
+        size_t sharedBuffers = 0;
+    };
+
+    static inline std::mutex registryMutex;
+    static inline std::vector<AudioGraph*> graphs;
+
+    AudioEndpoint* sink = nullptr;
+    std::atomic<Plan*> plan{ nullptr };
+    std::atomic<Plan*> renderingPlan{ nullptr };
+
+    static bool isSchedulable(AudioEndpoint* node, ma_uint32 sampleRate) {
+        if (!node->isGraphRenderable() || !node->isNegociationDone || node->isFannedOut()) return false;
+        if (node->outputNode == nullptr || node->outputNode->audioFormat.sampleRate != sampleRate) return false;
+        return node->getProducedFormat().sampleRate == sampleRate;
+    }
+
+    // A renegotiation publishes its pipeline before the plan is rebuilt, and a device changes
+    // format without renegotiating its inputs: a step whose node no longer renders, converts
+    // to or reads the formats its buffers were sized for can't run
+    static bool matches(const Step& step, const AudioEndpoint::Pipeline& p) {
+        if (p.selfFormat != step.self || p.producedFormat != step.produced) return false;
+        if (p.hasSelfToOutputConverter != step.converts) return false;
+        return !step.converts || (p.selfToOutputConverter.getInputFormat() == step.produced
+            && p.selfToOutputConverter.getOutputFormat() == step.consumer);
+    }
+
+    // Post-order walk, returns the step index or -1 when the node stays on the ring path
+    int schedule(Plan& target, AudioNode* node, ma_uint32 sampleRate, std::vector<AudioNode*>& visiting) {
+        // compile time only, never on the audio thread
+        auto* endpoint = dynamic_cast<AudioEndpoint*>(node);
+        if (endpoint == nullptr || !isSchedulable(endpoint, sampleRate)) return -1;
+        if (std::find(visiting.begin(), visiting.end(), node) != visiting.end()) return -1;
+        visiting.push_back(node);
+
+        std::vector<AudioNode*> inputs;
+        endpoint->collectGraphInputs(inputs);
+
+        std::vector<int> inputSteps;
+        for (AudioNode* input : inputs)
+            inputSteps.push_back(schedule(target, input, sampleRate, visiting));
+
+        auto step = std::make_unique<Step>();
+        step->node = endpoint;
+        step->self = endpoint->audioFormat;
+        step->produced = endpoint->getProducedFormat();
+        step->consumer = endpoint->outputNode->audioFormat;
+        step->converts = step->produced != step->consumer;
+
+        // the consumer's format, not just any converter
+        {
+            AudioEndpoint::PipelineScope scope(endpoint);
+            if (!matches(*step, endpoint->current())) return -1;
+        }
+
+        const AudioFormat& produced = step->produced;
+        if (step->converts)
+            step->converted.resize((size_t)step->consumer.frameSizeInBytes(target.blockFrames));
+
+        for (size_t i = 0; i < inputs.size(); i++)
+            step->inputs.push_back({ inputs[i], inputSteps[i] >= 0 ? target.steps[inputSteps[i]]->getOutput() : nullptr });
+
+        // a chain sharing one format renders in a single buffer, each node in place
+        const bool sharesInput = endpoint->canRenderInPlace() && step->inputs.size() == 1
+            && step->inputs[0].block != nullptr && produced == endpoint->audioFormat;
+        if (sharesInput) {
+            step->output = const_cast<void*>(step->inputs[0].block);
+            target.sharedBuffers++;
+        } else {
+            step->block.resize((size_t)produced.frameSizeInBytes(target.blockFrames));
+            step->output = step->block.data();
+        }
+
+        target.steps.push_back(std::move(step));
+        return (int)target.steps.size() - 1;
+    }
+
+    bool isCurrent(const Plan& target) {
+        {
+            AudioEndpoint::PipelineScope scope(sink);
+            if (sink->current().selfFormat != target.sinkFormat) return false;
+        }
+        for (auto& step : target.steps) {
+            AudioEndpoint::PipelineScope scope(step->node);
+            if (!matches(*step, step->node->current())) return false;
+        }
+        return true;
+    }
+
+    void retire(Plan* old) {
+        // the callback publishes the plan it renders before re-checking it is still current
+        while (renderingPlan.load() == old && old != nullptr)
+            std::this_thread::yield();
+        delete old;
+    }
+
+    void publish(Plan* next) {
+        retire(plan.exchange(next));
+    }
+
+public:
+    /// <summary>
+    /// Frames rendered per pass, longer device periods are rendered in several passes.
+    /// Applied on the next rebuild.
+    /// </summary>
+    ma_uint32 blockFrames = 512;
+
+    explicit AudioGraph(AudioEndpoint* sink) : sink(sink) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        graphs.push_back(this);
+    }
+
+    ~AudioGraph() {
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            graphs.erase(std::remove(graphs.begin(), graphs.end(), this), graphs.end());
+        }
+        publish(nullptr);
+    }
+
+    AudioGraph(const AudioGraph&) = delete;
+    AudioGraph& operator=(const AudioGraph&) = delete;
+
+    /// <summary>
+    /// Sorts the nodes feeding the sink and publishes the new plan. Call off the audio thread.
+    /// </summary>
+    void rebuild() {
+        AudioNode* input = sink->inputNode;
+        if (input == nullptr || !sink->isNegociationDone) {
+            publish(nullptr);
+            return;
+        }
+
+        auto next = std::make_unique<Plan>();
+        next->blockFrames = std::max<ma_uint32>(blockFrames, 1);
+        next->sinkFormat = sink->audioFormat;
+        next->sinkFrameSize = sink->audioFormat.frameSizeInBytes();
+
+        std::vector<AudioNode*> visiting;
+        if (schedule(*next, input, sink->audioFormat.sampleRate, visiting) < 0) {
+            publish(nullptr);
+            return;
+        }
+        publish(next.release());
+    }
+
+    /// <summary>
+    /// Renders one device period into pOut (sink format).
+    /// </summary>
+    /// <returns>False when nothing is scheduled, the sink should pull its input ring instead</returns>
+    bool render(void* pOut, ma_uint32 frameCount) {
+        Plan* current = nullptr;
+        do {
+            current = plan.load();
+            renderingPlan.store(current);
+        } while (current != plan.load());
+
+        // stale until the rebuild that follows the renegotiation, the rings carry the period
+        if (current == nullptr || !isCurrent(*current)) {
+            renderingPlan.store(nullptr);
+            return false;
+        }
+
+        ma_uint8* output = static_cast<ma_uint8*>(pOut);
+        for (ma_uint32 offset = 0; offset < frameCount; offset += current->blockFrames) {
+            const ma_uint32 frames = std::min(current->blockFrames, frameCount - offset);
+
+            for (auto& step : current->steps) {
+                AudioEndpoint::PipelineScope scope(step->node);
+                if (!matches(*step, step->node->current())) {
+                    // swapped since the check above, this period is lost rather than overrun
+                    ma_silence_pcm_frames(output + (size_t)offset * current->sinkFrameSize, frameCount - offset,
+                        current->sinkFormat.format, current->sinkFormat.channels);
+                    renderingPlan.store(nullptr);
+                    return true;
+                }
+                step->node->renderGraphBlock(step->inputs.data(), step->inputs.size(), step->output, frames);
+                step->node->forwardMarker(step->node->current(), frames);
+                if (!step->converts) continue;
+
+                ma_uint64 inF = frames;
+                ma_uint64 outF = frames;
+                step->node->current().selfToOutputConverter.process(step->output, &inF, step->converted.data(), &outF);
+            }
+
+            memcpy(output + (size_t)offset * current->sinkFrameSize,
+                current->steps.back()->getOutput(), (size_t)frames * current->sinkFrameSize);
+        }
+
+        renderingPlan.store(nullptr);
+        return true;
+    }
+
+    size_t getScheduledNodeCount() {
+        Plan* current = plan.load();
+        return current ? current->steps.size() : 0;
+    }
+
+    // Scheduled nodes rendering in place in their input's buffer
+    size_t getSharedBufferCount() {
+        Plan* current = plan.load();
+        return current ? current->sharedBuffers : 0;
+    }
+
+    // Every link or format change lands here, from the thread that made it
+    static void rebuildAll() {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (AudioGraph* graph : graphs)
+            graph->rebuild();
+    }
+};
+
+// needs both classes complete
+inline void AudioEndpoint::notifyTopologyChanged() {
+    AudioGraph::rebuildAll();
+}
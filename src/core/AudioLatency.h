@@ -0,0 +1,382 @@
+#pragma once
+
+#include "../include.h"
+
+class AudioNode;
+
+// How an endpoint sizes its output FIFO.
+// - Fixed: bufferSafetyMS, always.
+// - Adaptive: target latency follows the consumer's callback jitter between two bounds.
+enum class AudioLatencyMode {
+    Fixed,
+    Adaptive
+};
+
+enum class AudioLatencyReason {
+    Underrun, // the consumer was short of frames, target grows
+    Headroom  // frames never read during a whole window, target shrinks
+};
+
+// One change of the target latency.
+struct AudioLatencyAdjustment {
+    ma_uint64 callbackIndex = 0; // consumer callback that triggered it
+    ma_uint32 fromFrames = 0;
+    ma_uint32 toFrames = 0;
+    float jitterMS = 0.0f;       // callback interval jitter when it happened
+    AudioLatencyReason reason = AudioLatencyReason::Underrun;
+};
+
+// What a consumer read led to, see AudioLatencyController::onConsume().
+struct AudioLatencyEvent {
+    bool isUnderrun = false;
+    bool isAdjusted = false;
+    AudioLatencyAdjustment adjustment;
+};
+
+// Snapshot returned by AudioEndpoint::getLatencyTelemetry().
+struct AudioLatencyTelemetry {
+    AudioLatencyMode mode = AudioLatencyMode::Fixed;
+    ma_uint32 targetFrames = 0;    // fill the producer is held to (ring size when fixed)
+    ma_uint32 capacityFrames = 0;  // ring size
+    ma_uint32 lastFillFrames = 0;  // frames queued when the consumer last read
+    float targetMS = 0.0f;
+    float callbackIntervalMS = 0.0f;
+    float callbackJitterMS = 0.0f;
+    ma_uint64 callbacks = 0;
+    ma_uint64 underruns = 0;
+    ma_uint64 adjustments = 0;
+};
+
+// AudioLatencyController:
+// - Lives in an endpoint pipeline, configured before it is published.
+// - The consumer reports every read (onConsume), the controller keeps an average of the
+//   callback interval and its jitter, and the lowest fill seen over a window.
+// - At the end of a window: any underrun grows the target by half, otherwise frames that
+//   were never needed (lowest fill minus one period) are given back, half at a time.
+//   The target never goes below one period plus four times the jitter, nor out of bounds.
+// - The producer side only reads getTargetFrames() to cap what it queues, the ring itself
+//   is sized for the upper bound so nothing is reallocated.
+
+class AudioLatencyController {
+private:
+    static constexpr double windowSeconds = 0.25;
+    static constexpr double smoothing = 1.0 / 16.0;
+
+    // configuration
+    bool isEnabled = false;
+    ma_uint32 sampleRate = 0;
+    ma_uint32 minFrames = 0;
+    ma_uint32 maxFrames = 0;
+
+    // consumer thread
+    std::chrono::steady_clock::time_point lastCallback;
+    bool hasLastCallback = false;
+    double meanInterval = 0.0;
+    double jitter = 0.0;
+    double windowElapsed = 0.0;
+    ma_uint32 windowMinFill = UINT32_MAX;
+    ma_uint32 windowPeriod = 0;
+    ma_uint32 windowUnderruns = 0;
+    ma_uint32 lastRead = 0;
+    ma_uint64 callbackIndex = 0;
+
+    // shared
+    std::atomic<ma_uint32> targetFrames{ 0 };
+    std::atomic<ma_uint32> lastFill{ 0 };
+    std::atomic<float> intervalMS{ 0.0f };
+    std::atomic<float> jitterMS{ 0.0f };
+
+    ma_uint32 clampTarget(ma_uint64 frames) const {
+        return (ma_uint32)std::min<ma_uint64>(maxFrames, std::max<ma_uint64>(minFrames, frames));
+    }
+
+    bool evaluate(AudioLatencyAdjustment& adjustment) {
+        const ma_uint32 current = targetFrames.load(std::memory_order_relaxed);
+        const ma_uint64 floor = windowPeriod + (ma_uint64)(4.0 * jitter * sampleRate);
+
+        ma_uint64 next = current;
+        AudioLatencyReason reason = AudioLatencyReason::Underrun;
+        if (windowUnderruns > 0) {
+            next = std::max<ma_uint64>((ma_uint64)current * 3 / 2, floor);
+        }
+        else if (windowMinFill != UINT32_MAX && windowMinFill > windowPeriod) {
+            const ma_uint32 unused = std::min(current, (windowMinFill - windowPeriod) / 2);
+            next = std::max<ma_uint64>(current - unused, floor);
+            reason = AudioLatencyReason::Headroom;
+        }
+
+        const ma_uint32 clamped = clampTarget(next);
+        windowElapsed = 0.0;
+        windowMinFill = UINT32_MAX;
+        windowPeriod = 0;
+        windowUnderruns = 0;
+        if (clamped == current) return false;
+
+        targetFrames.store(clamped, std::memory_order_relaxed);
+        adjustment.callbackIndex = callbackIndex;
+        adjustment.fromFrames = current;
+        adjustment.toFrames = clamped;
+        adjustment.jitterMS = (float)(jitter * 1000.0);
+        adjustment.reason = reason;
+        return true;
+    }
+
+public:
+    // Off the audio thread, before the pipeline is published
+    void configure(bool enabled, ma_uint32 rate, ma_uint32 lowerFrames, ma_uint32 upperFrames, ma_uint32 initialFrames) {
+        isEnabled = enabled && rate > 0;
+        sampleRate = rate;
+        minFrames = std::min(lowerFrames, upperFrames);
+        maxFrames = upperFrames;
+        hasLastCallback = false;
+        meanInterval = jitter = windowElapsed = 0.0;
+        windowMinFill = UINT32_MAX;
+        windowPeriod = windowUnderruns = lastRead = 0;
+        callbackIndex = 0;
+        targetFrames.store(isEnabled ? clampTarget(initialFrames) : upperFrames, std::memory_order_relaxed);
+        lastFill.store(0, std::memory_order_relaxed);
+        intervalMS.store(0.0f, std::memory_order_relaxed);
+        jitterMS.store(0.0f, std::memory_order_relaxed);
+    }
+
+    bool isAdaptive() const { return isEnabled; }
+    ma_uint32 getTargetFrames() const { return targetFrames.load(std::memory_order_relaxed); }
+    ma_uint32 getLastFill() const { return lastFill.load(std::memory_order_relaxed); }
+    float getIntervalMS() const { return intervalMS.load(std::memory_order_relaxed); }
+    float getJitterMS() const { return jitterMS.load(std::memory_order_relaxed); }
+    ma_uint32 getSampleRate() const { return sampleRate; }
+
+    /// <summary>
+    /// Consumer thread, after every read of the FIFO.
+    /// </summary>
+    /// <param name="requested">Frames the consumer asked for</param>
+    /// <param name="read">Frames it got</param>
+    /// <param name="fillBefore">Frames queued before the read</param>
+    /// <param name="event">Receives whether it was an underrun and the adjustment it caused, if any</param>
+    void onConsume(ma_uint32 requested, ma_uint32 read, ma_uint32 fillBefore, AudioLatencyEvent& event) {
+        const auto now = std::chrono::steady_clock::now();
+        callbackIndex++;
+        lastFill.store(fillBefore, std::memory_order_relaxed);
+
+        if (hasLastCallback) {
+            const double interval = std::chrono::duration<double>(now - lastCallback).count();
+            meanInterval = meanInterval == 0.0 ? interval : meanInterval + (interval - meanInterval) * smoothing;
+            jitter += (std::fabs(interval - meanInterval) - jitter) * smoothing;
+            windowElapsed += interval;
+
+            intervalMS.store((float)(meanInterval * 1000.0), std::memory_order_relaxed);
+            jitterMS.store((float)(jitter * 1000.0), std::memory_order_relaxed);
+        }
+        lastCallback = now;
+        hasLastCallback = true;
+
+        // a source that stopped is only counted once, not on every silent callback
+        event.isUnderrun = read < requested && (read > 0 || lastRead > 0);
+        lastRead = read;
+        if (!isEnabled) return;
+
+        windowMinFill = std::min(windowMinFill, fillBefore);
+        windowPeriod = std::max(windowPeriod, requested);
+        if (event.isUnderrun) windowUnderruns++;
+
+        event.isAdjusted = windowElapsed >= windowSeconds && evaluate(event.adjustment);
+    }
+};
+
+// Timestamp carried along the frames of a path, see AudioEndpoint::latencyMarkerFrames.
+struct AudioLatencyMarker {
+    const AudioNode* origin = nullptr; // source that stamped it
+    ma_uint64 originId = 0;            // the same source, never reused unlike its address
+    ma_int64 timeNs = 0;               // steady clock, when its frame was captured / submitted
+    ma_uint64 position = 0;            // output FIFO frame it is attached to
+};
+
+// Latency of one path (origin -> sink), see AudioSpeakerDevice::getPathLatencies().
+struct AudioPathLatency {
+    const AudioNode* origin = nullptr;
+    ma_uint64 samples = 0;
+    float p50MS = 0.0f;
+    float p99MS = 0.0f;
+    float maxMS = 0.0f;
+};
+
+// AudioLatencyHistogram:
+// - Log buckets, 8 per octave of microseconds (about 12% resolution), up to an hour.
+// - record() is lock-free and allocation free, readers compute percentiles from a copy.
+
+class AudioLatencyHistogram {
+private:
+    static constexpr int bucketCount = 240;
+
+    std::atomic<ma_uint64> buckets[bucketCount];
+    std::atomic<ma_uint64> count{ 0 };
+    std::atomic<ma_uint64> maxMicroseconds{ 0 };
+
+    static int highestBit(ma_uint64 value) {
+        int bit = 0;
+        while (value >>= 1) bit++;
+        return bit;
+    }
+
+    static int bucketOf(ma_uint64 us) {
+        if (us < 8) return (int)us;
+        const int bit = highestBit(us);
+        return std::min(bucketCount - 1, (bit - 2) * 8 + (int)((us >> (bit - 3)) & 7));
+    }
+
+    // Middle of a bucket, in microseconds
+    static double bucketValue(int index) {
+        if (index < 8) return index;
+        const int bit = index / 8 + 2;
+        const double lower = (double)((ma_uint64)(8 + index % 8) << (bit - 3));
+        return lower + (double)((ma_uint64)1 << (bit - 3)) * 0.5;
+    }
+
+public:
+    AudioLatencyHistogram() { reset(); }
+
+    void reset() {
+        for (auto& bucket : buckets) bucket.store(0, std::memory_order_relaxed);
+        count.store(0, std::memory_order_relaxed);
+        maxMicroseconds.store(0, std::memory_order_relaxed);
+    }
+
+    void record(double seconds) {
+        const ma_uint64 us = seconds > 0.0 ? (ma_uint64)(seconds * 1e6) : 0;
+        buckets[bucketOf(us)].fetch_add(1, std::memory_order_relaxed);
+        count.fetch_add(1, std::memory_order_relaxed);
+
+        ma_uint64 current = maxMicroseconds.load(std::memory_order_relaxed);
+        while (us > current && !maxMicroseconds.compare_exchange_weak(current, us, std::memory_order_relaxed)) {}
+    }
+
+    void summarize(AudioPathLatency& out) const {
+        ma_uint64 copy[bucketCount];
+        ma_uint64 total = 0;
+        for (int i = 0; i < bucketCount; i++)
+            total += copy[i] = buckets[i].load(std::memory_order_relaxed);
+
+        out.samples = total;
+        out.maxMS = (float)(maxMicroseconds.load(std::memory_order_relaxed) / 1000.0);
+        if (total == 0) return;
+
+        const ma_uint64 p50 = (total + 1) / 2;
+        const ma_uint64 p99 = std::max<ma_uint64>(1, (total * 99 + 99) / 100);
+        ma_uint64 seen = 0;
+        bool hasP50 = false;
+        for (int i = 0; i < bucketCount; i++) {
+            seen += copy[i];
+            if (!hasP50 && seen >= p50) {
+                out.p50MS = (float)(bucketValue(i) / 1000.0);
+                hasP50 = true;
+            }
+            if (seen >= p99) {
+                out.p99MS = (float)(bucketValue(i) / 1000.0);
+                break;
+            }
+        }
+        out.p50MS = std::min(out.p50MS, out.maxMS);
+        out.p99MS = std::min(out.p99MS, out.maxMS);
+    }
+};
+
+// AudioLatencyPaths:
+// - One histogram per origin, for a sink. Slots are claimed lock-free on the first marker
+//   of an origin, markers of origins beyond the last slot are only counted.
+// - Origins are told apart by id rather than address, a node created where a destroyed one
+//   lived starts its own histogram. Destroyed origins free their slots (forgetOrigin()).
+
+class AudioLatencyPaths {
+private:
+    static constexpr size_t slotCount = 8;
+
+    static inline std::mutex registryMutex;
+    static inline std::vector<AudioLatencyPaths*> registry;
+
+    std::atomic<ma_uint64> ids[slotCount];
+    std::atomic<const AudioNode*> origins[slotCount];
+    AudioLatencyHistogram histograms[slotCount];
+    std::atomic<ma_uint64> overflow{ 0 };
+
+    // a marker already past the id check can still land in the slot's next origin
+    void clearSlot(size_t slot) {
+        origins[slot].store(nullptr, std::memory_order_relaxed);
+        histograms[slot].reset();
+        ids[slot].store(0, std::memory_order_release);
+    }
+
+public:
+    AudioLatencyPaths() {
+        for (size_t i = 0; i < slotCount; i++) {
+            ids[i].store(0, std::memory_order_relaxed);
+            origins[i].store(nullptr, std::memory_order_relaxed);
+        }
+        std::lock_guard<std::mutex> lock(registryMutex);
+        registry.push_back(this);
+    }
+
+    ~AudioLatencyPaths() {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        registry.erase(std::remove(registry.begin(), registry.end(), this), registry.end());
+    }
+
+    AudioLatencyPaths(const AudioLatencyPaths&) = delete;
+    AudioLatencyPaths& operator=(const AudioLatencyPaths&) = delete;
+
+    // Fresh id for a node that stamps markers
+    static ma_uint64 makeOriginId() {
+        static std::atomic<ma_uint64> next{ 1 };
+        return next.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // The origin is gone, every sink frees its slot for the next one
+    static void forgetOrigin(ma_uint64 id) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (AudioLatencyPaths* paths : registry)
+            for (size_t i = 0; i < slotCount; i++)
+                if (paths->ids[i].load(std::memory_order_acquire) == id) paths->clearSlot(i);
+    }
+
+    void record(const AudioLatencyMarker& marker, double seconds) {
+        if (marker.originId == 0) return;
+        for (size_t i = 0; i < slotCount; i++) {
+            ma_uint64 current = ids[i].load(std::memory_order_acquire);
+            if (current == 0) {
+                ma_uint64 expected = 0;
+                if (ids[i].compare_exchange_strong(expected, marker.originId, std::memory_order_acq_rel)) {
+                    origins[i].store(marker.origin, std::memory_order_release);
+                    histograms[i].record(seconds);
+                    return;
+                }
+                current = expected;
+            }
+            if (current == marker.originId) {
+                histograms[i].record(seconds);
+                return;
+            }
+        }
+        overflow.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::vector<AudioPathLatency> summarize() const {
+        std::vector<AudioPathLatency> out;
+        for (size_t i = 0; i < slotCount; i++) {
+            const AudioNode* origin = origins[i].load(std::memory_order_acquire);
+            if (origin == nullptr) continue; // free, or being claimed
+
+            AudioPathLatency path;
+            path.origin = origin;
+            histograms[i].summarize(path);
+            out.push_back(path);
+        }
+        return out;
+    }
+
+    // Frees every slot, the origins still stamping claim one again
+    void reset() {
+        for (size_t i = 0; i < slotCount; i++) clearSlot(i);
+        overflow.store(0, std::memory_order_relaxed);
+    }
+
+    ma_uint64 getOverflow() const { return overflow.load(std::memory_order_relaxed); }
+};
@@ -0,0 +1,238 @@
+#pragma once
+
+#include "../include.h"
+#include "./AudioFormat.h"
+#include "../utils/mappedfile.h"
+
+// AudioMappedPCM:
+// - Uncompressed PCM (WAV or headerless raw) read straight out of a memory mapping, no decoder.
+// - A frame is an offset into the mapping: reads are a single copy and seeks only move the cursor.
+// - Read-ahead: the mapping is marked sequential, and the next readAheadBytes past the cursor
+//   are prefetched whenever the reader gets halfway through the last prefetched window.
+// - Samples are used as stored, little-endian hosts only (what WAV stores).
+// - attachMemory() / attachWav() read PCM someone else keeps alive the same way (a cached decoded
+//   asset, a WAV loaded from an archive).
+
+class AudioMappedPCM {
+private:
+    MappedFile file;
+    const ma_uint8* fileData = nullptr; // the mapping or the attached WAV, header included
+    size_t fileSize = 0;
+    AudioFormat format;
+    const ma_uint8* frames = nullptr;
+    ma_uint64 frameCount = 0;
+    ma_uint32 frameSize = 0;
+    bool isWav = false;
+
+    std::atomic<ma_uint64> cursor{ 0 };
+    size_t prefetchedUntil = 0; // byte offset in the data, reader side
+
+    static ma_uint16 readU16(const ma_uint8* p) { return (ma_uint16)(p[0] | (p[1] << 8)); }
+    static ma_uint32 readU32(const ma_uint8* p) { return (ma_uint32)p[0] | ((ma_uint32)p[1] << 8) | ((ma_uint32)p[2] << 16) | ((ma_uint32)p[3] << 24); }
+
+    // fmt chunk -> sample format, ma_format_unknown for anything that needs decoding
+    static ma_format toSampleFormat(ma_uint16 tag, ma_uint16 bits) {
+        if (tag == 1) {
+            switch (bits) {
+            case 8:  return ma_format_u8;
+            case 16: return ma_format_s16;
+            case 24: return ma_format_s24;
+            case 32: return ma_format_s32;
+            }
+        }
+        if (tag == 3 && bits == 32) return ma_format_f32;
+        return ma_format_unknown;
+    }
+
+    ma_result attach(const AudioFormat& pcmFormat, const ma_uint8* base, size_t size, size_t offset, size_t bytes) {
+        frameSize = pcmFormat.frameSizeInBytes();
+        if (base == nullptr || frameSize == 0 || pcmFormat.sampleRate == 0 || offset > size) {
+            close();
+            return MA_INVALID_FILE;
+        }
+
+        format = pcmFormat;
+        frames = base + offset;
+        frameCount = std::min(bytes, size - offset) / frameSize;
+        cursor = 0;
+        prefetchedUntil = 0;
+
+        file.adviseSequential();
+        prefetchAhead(0);
+        return MA_SUCCESS;
+    }
+
+    void prefetchAhead(size_t position) {
+        if (!file.isOpen() || readAheadBytes == 0 || position + readAheadBytes / 2 < prefetchedUntil) return;
+
+        const size_t start = std::max(position, prefetchedUntil);
+        file.prefetch((size_t)(frames - file.data()) + start, readAheadBytes);
+        prefetchedUntil = start + readAheadBytes;
+    }
+
+    // RIFF/WAVE at data: finds the fmt and data chunks
+    ma_result parseWav(const ma_uint8* data, size_t size) {
+        if (data == nullptr || size < 12 || memcmp(data, "RIFF", 4) != 0 || memcmp(data + 8, "WAVE", 4) != 0) {
+            close();
+            return MA_INVALID_FILE;
+        }
+
+        AudioFormat pcmFormat;
+        bool hasFormat = false;
+        size_t offset = 12;
+
+        while (offset + 8 <= size) {
+            const ma_uint8* chunk = data + offset;
+            const size_t chunkSize = readU32(chunk + 4);
+            const size_t body = offset + 8;
+
+            if (memcmp(chunk, "fmt ", 4) == 0 && chunkSize >= 16 && body + 16 <= size) {
+                ma_uint16 tag = readU16(chunk + 8);
+                const ma_uint16 channels = readU16(chunk + 10);
+                const ma_uint32 sampleRate = readU32(chunk + 12);
+                const ma_uint16 bits = readU16(chunk + 22);
+
+                // WAVE_FORMAT_EXTENSIBLE: the real tag opens the sub-format GUID
+                if (tag == 0xFFFE && chunkSize >= 40 && body + 40 <= size)
+                    tag = readU16(chunk + 32);
+
+                const ma_format sampleFormat = toSampleFormat(tag, bits);
+                if (sampleFormat == ma_format_unknown || channels == 0) {
+                    close();
+                    return MA_FORMAT_NOT_SUPPORTED;
+                }
+
+                pcmFormat = AudioFormat(sampleFormat, channels, sampleRate);
+                hasFormat = true;
+            }
+            else if (memcmp(chunk, "data", 4) == 0) {
+                if (!hasFormat) break;
+                // streamed writers leave the size at 0 or ~0, the rest of the file is data then
+                const size_t bytes = (chunkSize == 0 || chunkSize == 0xFFFFFFFF) ? size - body : chunkSize;
+                isWav = true;
+                fileData = data;
+                fileSize = size;
+                return attach(pcmFormat, data, size, body, bytes);
+            }
+
+            offset = body + chunkSize + (chunkSize & 1); // chunks are word aligned
+        }
+
+        close();
+        return MA_INVALID_FILE;
+    }
+
+public:
+    /// <summary>
+    /// How far past the cursor pages are prefetched, in bytes. Default is 256 KiB.
+    /// </summary>
+    size_t readAheadBytes = 256 * 1024;
+
+    AudioMappedPCM() = default;
+
+    AudioMappedPCM(const AudioMappedPCM&) = delete;
+    AudioMappedPCM& operator=(const AudioMappedPCM&) = delete;
+
+    /// <summary>
+    /// Maps a RIFF/WAVE file holding integer or float PCM.
+    /// </summary>
+    /// <returns>MA_INVALID_FILE when it is not a WAV, MA_FORMAT_NOT_SUPPORTED when it needs a decoder</returns>
+    ma_result openWav(const std::string& path) {
+        close();
+        ma_result result = file.open(path);
+        if (result != MA_SUCCESS) return result;
+        return parseWav(file.data(), file.size());
+    }
+
+    /// <summary>
+    /// Reads a whole WAV file at pData in place, which must outlive this reader (nothing is copied).
+    /// </summary>
+    /// <returns>MA_INVALID_FILE when it is not a WAV, MA_FORMAT_NOT_SUPPORTED when it needs a decoder</returns>
+    ma_result attachWav(const void* pData, size_t size) {
+        close();
+        return parseWav((const ma_uint8*)pData, size);
+    }
+
+    /// <summary>
+    /// Maps headerless PCM in pcmFormat, starting headerBytes into the file.
+    /// </summary>
+    ma_result openRaw(const std::string& path, const AudioFormat& pcmFormat, size_t headerBytes = 0) {
+        close();
+        ma_result result = file.open(path);
+        if (result != MA_SUCCESS) return result;
+        fileData = file.data();
+        fileSize = file.size();
+        return attach(pcmFormat, file.data(), file.size(), headerBytes, file.size());
+    }
+
+    /// <summary>
+    /// Reads frameCount frames of pcmFormat at pData, which must outlive this reader (nothing is copied).
+    /// </summary>
+    ma_result attachMemory(const AudioFormat& pcmFormat, const void* pData, ma_uint64 frameCount) {
+        close();
+        const size_t bytes = (size_t)(frameCount * pcmFormat.frameSizeInBytes());
+        return attach(pcmFormat, (const ma_uint8*)pData, bytes, 0, bytes);
+    }
+
+    void close() {
+        file.close();
+        fileData = nullptr;
+        fileSize = 0;
+        frames = nullptr;
+        frameCount = 0;
+        frameSize = 0;
+        isWav = false;
+        cursor = 0;
+        prefetchedUntil = 0;
+    }
+
+    bool isOpen() const { return frames != nullptr; }
+    bool isWavFile() const { return isWav; }
+
+    // The whole file, header included (for a decoder reading from memory)
+    const void* getFileData() const { return fileData; }
+    size_t getFileSize() const { return fileSize; }
+    const AudioFormat& getFormat() const { return format; }
+    ma_uint64 getLengthInFrames() const { return frameCount; }
+    ma_uint64 getCursor() const { return cursor.load(std::memory_order_relaxed); }
+    bool isAtEnd() const { return getCursor() >= frameCount; }
+
+    /// <summary>
+    /// Frames from the cursor, in place: up to maxFrames contiguous frames, nothing is copied.
+    /// Call advance() once they were used.
+    /// </summary>
+    const void* peek(ma_uint32 maxFrames, ma_uint32* available) {
+        const ma_uint64 position = getCursor();
+        *available = (ma_uint32)std::min<ma_uint64>(maxFrames, frameCount - std::min(position, frameCount));
+        return frames ? frames + position * frameSize : nullptr;
+    }
+
+    void advance(ma_uint32 framesUsed) {
+        const ma_uint64 position = std::min(getCursor() + framesUsed, frameCount);
+        cursor.store(position, std::memory_order_relaxed);
+        prefetchAhead((size_t)(position * frameSize));
+    }
+
+    ma_uint32 read(void* pOut, ma_uint32 maxFrames) {
+        ma_uint32 available = 0;
+        const void* source = peek(maxFrames, &available);
+        if (available == 0) return 0;
+
+        memcpy(pOut, source, (size_t)available * frameSize);
+        advance(available);
+        return available;
+    }
+
+    /// <summary>
+    /// Moves the cursor, the pages around the new position are prefetched.
+    /// </summary>
+    ma_result seek(ma_uint64 frame) {
+        if (!isOpen()) return MA_INVALID_OPERATION;
+        if (frame > frameCount) return MA_INVALID_ARGS;
+
+        cursor.store(frame, std::memory_order_relaxed);
+        prefetchedUntil = (size_t)(frame * frameSize);
+        prefetchAhead(prefetchedUntil);
+        return MA_SUCCESS;
+    }
+};
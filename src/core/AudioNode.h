@@ -5,116 +5,107 @@
 
 class AudioNode {
     friend class AudioEndpoint;
+    friend class AudioGraph;
 
 protected:
-    using IsSubscribedMethod = bool (AudioNode::*)();
-    using HandleMethod = ma_result(AudioNode::*)(AudioNode*);
-
     AudioNode* inputNode = nullptr;
-    AudioNode* outputNode = nullptr;
+    AudioNode* outputNode = nullptr;          // primary output, clocks this node
+    std::vector<AudioNode*> outputNodes;      // every output (fan-out), primary first
 
     virtual ma_result handleInputSubscribe(AudioNode*) { return MA_SUCCESS; }
     virtual ma_result handleOutputSubscribe(AudioNode*) { return MA_SUCCESS; }
     virtual ma_result handleInputUnsubscribe(AudioNode*) { return MA_SUCCESS; }
     virtual ma_result handleOutputUnsubscribe(AudioNode*) { return MA_SUCCESS; }
 
+    // Before a link is made: nodes that learn their format lazily (devices) settle audioFormat here
+    virtual void resolveFormat() {}
+
     bool isInputSubscribed() { return inputNode != nullptr; }
     bool isOutputSubscribed() { return outputNode != nullptr; }
     bool areBothSubscribed() { return isInputSubscribed() && isOutputSubscribed(); }
 
+    bool isFannedOut() const { return outputNodes.size() > 1; }
+    size_t getOutputIndex(const AudioNode* node) const {
+        return std::find(outputNodes.begin(), outputNodes.end(), node) - outputNodes.begin();
+    }
+    bool hasOutputNode(const AudioNode* node) const { return getOutputIndex(node) < outputNodes.size(); }
+
     AudioFormat audioFormat;
 
-    ma_result _subscribe(
-        AudioNode*& audioNode,
-        IsSubscribedMethod isSubscribedMethod,
-        HandleMethod handleMethod,
-        AudioNode* otherNode,
-        HandleMethod otherHandleMethod
-    ) {
-        if ((this->*isSubscribedMethod)())
+    // Links are always made from the source side: a node has one input and any number of outputs
+    ma_result linkOutput(AudioNode* destination) {
+        if (destination == nullptr) return MA_INVALID_ARGS;
+        if (hasOutputNode(destination) || destination->isInputSubscribed())
             return MA_DEVICE_ALREADY_INITIALIZED;
 
-        SI_LOG("subscribe begin: this=" << this << ", other=" << otherNode);
-        SI_LOG("is output node: " << (otherNode == outputNode));
+        SI_LOG("subscribe begin: this=" << this << ", other=" << destination);
+
+        resolveFormat();
+        destination->resolveFormat();
 
-        audioNode = otherNode;
-        if (otherNode) {
-            if (otherNode == outputNode)
-                otherNode->inputNode = this;
-            else
-                otherNode->outputNode = this;
-        }
+        outputNodes.push_back(destination);
+        if (!outputNode) outputNode = destination;
+        destination->inputNode = this;
 
-        ma_result result = (this->*handleMethod)(otherNode);
+        ma_result result = handleOutputSubscribe(destination);
         if (result != MA_SUCCESS)
             return result;
 
-        if (otherNode)
-            (otherNode->*otherHandleMethod)(this);
+        destination->handleInputSubscribe(this);
 
-        SI_LOG("subscribe done: inputNode=" << inputNode << ", outputNode=" << outputNode);
+        SI_LOG("subscribe done: outputs=" << outputNodes.size() << ", outputNode=" << outputNode);
         return result;
     }
 
-
-    ma_result _unsubscribe(
-        AudioNode*& audioNode,
-        IsSubscribedMethod isSubscribedMethod,
-        HandleMethod handleMethod
-    ) {
-        if (!(this->*isSubscribedMethod)())
+    ma_result unlinkOutput(AudioNode* destination) {
+        size_t index = getOutputIndex(destination);
+        if (index >= outputNodes.size())
             return MA_DEVICE_NOT_INITIALIZED;
 
-        SI_LOG("unsubscribe begin: this=" << this << ", peer=" << audioNode);
+        SI_LOG("unsubscribe begin: this=" << this << ", peer=" << destination);
 
-        AudioNode* peer = audioNode;  // store peer
-        audioNode = nullptr;          // break the link immediately
+        // break both sides immediately, next output becomes primary
+        outputNodes.erase(outputNodes.begin() + index);
+        outputNode = outputNodes.empty() ? nullptr : outputNodes.front();
+        destination->inputNode = nullptr;
 
-        ma_result result = (this->*handleMethod)(peer);
+        ma_result result = handleOutputUnsubscribe(destination);
         if (result != MA_SUCCESS)
             return result;
 
-        if (peer) {
-            if (peer->outputNode == this) {
-                peer->outputNode = nullptr; // break other side
-                peer->handleOutputUnsubscribe(this);
-            }
-            if (peer->inputNode == this) {
-                peer->inputNode = nullptr; // break other side
-                peer->handleInputUnsubscribe(this);
-            }
-        }
-
-        SI_LOG("unsubscribe done: inputNode=" << inputNode << ", outputNode=" << outputNode);
+        destination->handleInputUnsubscribe(this);
+
+        SI_LOG("unsubscribe done: outputs=" << outputNodes.size() << ", outputNode=" << outputNode);
         return MA_SUCCESS;
     }
 
     ma_result subscribeInput(AudioNode* source) {
-        return _subscribe(inputNode,
-            &AudioNode::isInputSubscribed,
-            &AudioNode::handleInputSubscribe,
-            source,
-            &AudioNode::handleOutputSubscribe);
+        if (source == nullptr) return MA_INVALID_ARGS;
+        if (isInputSubscribed()) return MA_DEVICE_ALREADY_INITIALIZED;
+        return source->linkOutput(this);
     }
 
     ma_result subscribeOutput(AudioNode* destination) {
-        return _subscribe(outputNode,
-            &AudioNode::isOutputSubscribed,
-            &AudioNode::handleOutputSubscribe,
-            destination,
-            &AudioNode::handleInputSubscribe);
+        return linkOutput(destination);
     }
 
     ma_result unsubscribeInput() {
-        return _unsubscribe(inputNode,
-            &AudioNode::isInputSubscribed,
-            &AudioNode::handleInputUnsubscribe);
+        if (!isInputSubscribed()) return MA_DEVICE_NOT_INITIALIZED;
+        return inputNode->unlinkOutput(this);
+    }
+
+    ma_result unsubscribeOutput(AudioNode* destination) {
+        return unlinkOutput(destination);
     }
 
+    // Unsubscribes every output
     ma_result unsubscribeOutput() {
-        return _unsubscribe(outputNode,
-            &AudioNode::isOutputSubscribed,
-            &AudioNode::handleOutputUnsubscribe);
+        if (!isOutputSubscribed()) return MA_DEVICE_NOT_INITIALIZED;
+
+        ma_result result = MA_SUCCESS;
+        while (!outputNodes.empty() && result == MA_SUCCESS)
+            result = unlinkOutput(outputNodes.back());
+        return result;
     }
 
     virtual bool isSubscribed() { return false; }
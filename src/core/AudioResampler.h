@@ -0,0 +1,375 @@
+#pragma once
+
+#include "../include.h"
+#include "../utils/simdfir.h"
+
+// Resampler tier used wherever a converter or decoder changes the sample rate
+enum class AudioResampleQuality {
+    Linear,  // miniaudio's linear resampler: cheapest, audible aliasing on bright material
+    Sinc,    // polyphase windowed sinc, 48 taps (~70 dB stopband), realtime
+    Offline, // polyphase windowed sinc, 160 taps (~120 dB stopband), for transcodes and renders
+};
+
+// AudioResampler:
+// - Polyphase windowed-sinc (Kaiser) resampler plugged into miniaudio as a custom resampling backend,
+//   so ma_data_converter and ma_decoder run it in place of the linear one (always in f32).
+// - The rate ratio is reduced to L/M. Up to 1024 phases every phase gets its own row of taps, which
+//   covers every pair of standard rates (44.1k <-> 48k is 160/147, 48k -> 16k is 1/3). Other ratios
+//   interpolate between neighbouring rows of a finer table.
+// - Tables are built once per ratio and tier and shared by every resampler in the process;
+//   prepare() builds them ahead of time. The dot products use the vectorized kernel of utils/simdfir.h.
+// - Samples are kept deinterleaved per channel. The output is aligned on the input (no delay),
+//   half the filter length is the latency.
+
+class AudioResampler {
+private:
+    struct Tier {
+        ma_uint32 taps;              // filter length at 1:1, scaled up when downsampling
+        double rolloff;              // cutoff relative to the lower Nyquist frequency
+        double beta;                 // Kaiser window shape
+        ma_uint32 interpolatedRows;  // table resolution for ratios without exact phases
+    };
+
+    static constexpr Tier sincTier = { 48, 0.90, 6.76, 256 };
+    static constexpr Tier offlineTier = { 160, 0.95, 12.27, 2048 };
+    static constexpr ma_uint32 maxExactPhases = 1024;
+    static constexpr ma_uint32 maxTaps = 4096;
+    static constexpr ma_uint32 blockFrames = 1024; // input absorbed per pass, on top of the filter length
+
+    struct Table {
+        ma_uint32 rows = 0;
+        ma_uint32 taps = 0;
+        std::vector<float> coefficients; // rows x taps, row r is the filter at offset r / steps
+    };
+
+    using TableKey = std::tuple<const Tier*, ma_uint32, ma_uint32, ma_uint32, ma_uint32>; // tier, rows, steps, taps, L / M in 1/65536
+
+    static std::mutex& getTableLock() { static std::mutex lock; return lock; }
+    static std::map<TableKey, std::shared_ptr<const Table>>& getTables() {
+        static std::map<TableKey, std::shared_ptr<const Table>> tables;
+        return tables;
+    }
+
+    static double besselI0(double x) {
+        double sum = 1.0, term = 1.0;
+        const double half = x * 0.5;
+        for (int k = 1; k < 64 && term > sum * 1e-17; k++) {
+            term *= (half / k) * (half / k);
+            sum += term;
+        }
+        return sum;
+    }
+
+    static std::shared_ptr<const Table> buildTable(const Tier& tier, ma_uint32 rows, ma_uint32 steps, ma_uint32 taps, double cutoff) {
+        auto table = std::make_shared<Table>();
+        table->rows = rows;
+        table->taps = taps;
+        table->coefficients.resize((size_t)rows * taps);
+
+        const double half = taps * 0.5;
+        const double normalizer = 1.0 / besselI0(tier.beta);
+        std::vector<double> row(taps);
+
+        for (ma_uint32 r = 0; r < rows; r++) {
+            double sum = 0.0;
+            for (ma_uint32 k = 0; k < taps; k++) {
+                // distance from the output instant to the input sample under tap k
+                const double t = (double)r / steps + half - 1.0 - k;
+                const double u = t / half;
+                double value = 0.0;
+                if (u > -1.0 && u < 1.0) {
+                    const double x = MA_PI_D * cutoff * t;
+                    const double sinc = std::fabs(x) < 1e-12 ? 1.0 : std::sin(x) / x;
+                    value = cutoff * sinc * besselI0(tier.beta * std::sqrt(1.0 - u * u)) * normalizer;
+                }
+                row[k] = value;
+                sum += value;
+            }
+
+            // unity gain at DC on every phase
+            float* target = table->coefficients.data() + (size_t)r * taps;
+            for (ma_uint32 k = 0; k < taps; k++)
+                target[k] = (float)(row[k] / sum);
+        }
+        return table;
+    }
+
+    static const Tier* getTier(AudioResampleQuality quality) {
+        return quality == AudioResampleQuality::Offline ? &offlineTier : &sincTier;
+    }
+
+    static ma_uint32 gcd(ma_uint32 a, ma_uint32 b) {
+        while (b != 0) { const ma_uint32 t = a % b; a = b; b = t; }
+        return a;
+    }
+
+    static std::shared_ptr<const Table> acquireTable(const Tier& tier, ma_uint32 up, ma_uint32 down, bool& isInterpolated) {
+        isInterpolated = up > maxExactPhases;
+        // interpolated tables carry one extra row so row + 1 always exists
+        const ma_uint32 steps = isInterpolated ? tier.interpolatedRows : up;
+        const ma_uint32 rows = isInterpolated ? steps + 1 : up;
+
+        // when downsampling the cutoff follows the output Nyquist and the filter widens to match
+        const double scale = std::min(1.0, (double)up / down);
+        const double cutoff = tier.rolloff * scale;
+        ma_uint32 taps = (ma_uint32)std::ceil(tier.taps / scale);
+        taps = std::min(maxTaps, (taps + 7) & ~7u);
+
+        const TableKey key = { &tier, rows, steps, taps, (ma_uint32)std::lround(scale * 65536.0) };
+        std::lock_guard<std::mutex> guard(getTableLock());
+        auto& tables = getTables();
+        auto found = tables.find(key);
+        if (found != tables.end()) return found->second;
+
+        auto table = buildTable(tier, rows, steps, taps, cutoff);
+        tables.emplace(key, table);
+        return table;
+    }
+
+    // State
+
+    ma_uint32 channels = 0;
+    ma_uint32 up = 1;   // L
+    ma_uint32 down = 1; // M
+    ma_uint32 taps = 0;
+    bool isInterpolated = false;
+    std::shared_ptr<const Table> table;
+
+    std::vector<float> window; // one plane of `capacity` frames per channel
+    ma_uint32 capacity = 0;
+    ma_uint32 filled = 0;      // frames in the window
+    ma_uint32 position = 0;    // first frame under the filter for the next output
+    ma_uint64 phase = 0;       // next output sits phase / L frames after position
+    ma_uint64 skip = 0;        // input frames to drop before filling (position ran past the window)
+
+    void reset() {
+        std::fill(window.begin(), window.end(), 0.0f);
+        filled = taps / 2 - 1; // zeros before the first frame so output 0 lands on input 0
+        position = 0;
+        phase = 0;
+        skip = 0;
+    }
+
+    ma_result init(const ma_resampler_config& config, const Tier& tier) {
+        if (config.format != ma_format_f32) return MA_FORMAT_NOT_SUPPORTED;
+        if (config.channels == 0 || config.sampleRateIn == 0 || config.sampleRateOut == 0) return MA_INVALID_ARGS;
+
+        const ma_uint32 divisor = gcd(config.sampleRateIn, config.sampleRateOut);
+        channels = config.channels;
+        up = config.sampleRateOut / divisor;
+        down = config.sampleRateIn / divisor;
+        table = acquireTable(tier, up, down, isInterpolated);
+        taps = table->taps;
+
+        capacity = taps + blockFrames;
+        window.assign((size_t)capacity * channels, 0.0f);
+        reset();
+        return MA_SUCCESS;
+    }
+
+    void emit(float* out) {
+        const float* plane = window.data() + position;
+        if (!isInterpolated) {
+            const float* row = table->coefficients.data() + phase * taps;
+            for (ma_uint32 c = 0; c < channels; c++, plane += capacity) {
+                const float value = dotF32(row, plane, taps);
+                if (out) out[c] = value;
+            }
+            return;
+        }
+
+        // between two rows of the fine table
+        const ma_uint64 scaled = phase * (table->rows - 1);
+        const ma_uint64 index = scaled / up;
+        const float fraction = (float)(scaled - index * up) / (float)up;
+        const float* lower = table->coefficients.data() + index * taps;
+        const float* upper = lower + taps;
+        for (ma_uint32 c = 0; c < channels; c++, plane += capacity) {
+            const float a = dotF32(lower, plane, taps);
+            const float b = dotF32(upper, plane, taps);
+            if (out) out[c] = a + (b - a) * fraction;
+        }
+    }
+
+    void absorb(const float* in, ma_uint32 frames) {
+        for (ma_uint32 c = 0; c < channels; c++) {
+            float* plane = window.data() + (size_t)c * capacity + filled;
+            if (in == nullptr) std::fill(plane, plane + frames, 0.0f);
+            else for (ma_uint32 i = 0; i < frames; i++) plane[i] = in[(size_t)i * channels + c];
+        }
+        filled += frames;
+    }
+
+    ma_result process(const float* in, ma_uint64* inFrames, float* out, ma_uint64* outFrames) {
+        const ma_uint64 inCapacity = *inFrames;
+        const ma_uint64 outCapacity = *outFrames;
+        ma_uint64 consumed = 0;
+        ma_uint64 produced = 0;
+
+        while (true) {
+            while (produced < outCapacity && position + taps <= filled) {
+                emit(out ? out + produced * channels : nullptr);
+                produced++;
+                phase += down;
+                position += (ma_uint32)(phase / up);
+                phase %= up;
+            }
+            if (consumed == inCapacity) break;
+
+            // slide what the filter still needs to the front of the window
+            if (position >= filled) {
+                skip += position - filled;
+                position = filled = 0;
+            }
+            else if (position > 0) {
+                const ma_uint32 kept = filled - position;
+                for (ma_uint32 c = 0; c < channels; c++) {
+                    float* plane = window.data() + (size_t)c * capacity;
+                    memmove(plane, plane + position, kept * sizeof(float));
+                }
+                filled = kept;
+                position = 0;
+            }
+
+            const ma_uint64 dropped = std::min(skip, inCapacity - consumed);
+            skip -= dropped;
+            consumed += dropped;
+
+            const ma_uint32 taken = (ma_uint32)std::min<ma_uint64>(capacity - filled, inCapacity - consumed);
+            absorb(in ? in + consumed * channels : nullptr, taken);
+            consumed += taken;
+
+            // window full and nowhere to write
+            if (dropped == 0 && taken == 0) break;
+        }
+
+        *inFrames = consumed;
+        *outFrames = produced;
+        return MA_SUCCESS;
+    }
+
+    ma_uint64 getRequiredInputFrames(ma_uint64 outputFrames) const {
+        if (outputFrames == 0) return 0;
+        const ma_uint64 last = position + (phase + (outputFrames - 1) * down) / up;
+        const ma_uint64 end = last + taps;
+        return (end > filled ? end - filled : 0) + skip;
+    }
+
+    ma_uint64 getExpectedOutputFrames(ma_uint64 inputFrames) const {
+        const ma_uint64 total = filled + (inputFrames > skip ? inputFrames - skip : 0);
+        if (total < (ma_uint64)position + taps) return 0;
+        const ma_uint64 span = total - position - taps; // last position an output can start at, relative
+        return ((span + 1) * up - phase + down - 1) / down;
+    }
+
+    // miniaudio backend
+
+    static ma_result onGetHeapSize(void*, const ma_resampler_config*, size_t* pHeapSizeInBytes) {
+        *pHeapSizeInBytes = sizeof(AudioResampler);
+        return MA_SUCCESS;
+    }
+
+    static ma_result onInit(void* pUserData, const ma_resampler_config* pConfig, void* pHeap, ma_resampling_backend** ppBackend) {
+        AudioResampler* resampler = new (pHeap) AudioResampler();
+        ma_result result = resampler->init(*pConfig, *(const Tier*)pUserData);
+        if (result != MA_SUCCESS) {
+            resampler->~AudioResampler();
+            return result;
+        }
+        *ppBackend = resampler;
+        return MA_SUCCESS;
+    }
+
+    static void onUninit(void*, ma_resampling_backend* pBackend, const ma_allocation_callbacks*) {
+        ((AudioResampler*)pBackend)->~AudioResampler(); // miniaudio frees the heap
+    }
+
+    static ma_result onProcess(void*, ma_resampling_backend* pBackend, const void* pFramesIn, ma_uint64* pFrameCountIn, void* pFramesOut, ma_uint64* pFrameCountOut) {
+        return ((AudioResampler*)pBackend)->process((const float*)pFramesIn, pFrameCountIn, (float*)pFramesOut, pFrameCountOut);
+    }
+
+    static ma_uint64 onGetInputLatency(void*, const ma_resampling_backend* pBackend) {
+        return ((const AudioResampler*)pBackend)->taps / 2;
+    }
+
+    static ma_uint64 onGetOutputLatency(void*, const ma_resampling_backend* pBackend) {
+        const AudioResampler* resampler = (const AudioResampler*)pBackend;
+        return (ma_uint64)resampler->taps / 2 * resampler->up / resampler->down;
+    }
+
+    static ma_result onGetRequiredInputFrameCount(void*, const ma_resampling_backend* pBackend, ma_uint64 outputFrameCount, ma_uint64* pInputFrameCount) {
+        *pInputFrameCount = ((const AudioResampler*)pBackend)->getRequiredInputFrames(outputFrameCount);
+        return MA_SUCCESS;
+    }
+
+    static ma_result onGetExpectedOutputFrameCount(void*, const ma_resampling_backend* pBackend, ma_uint64 inputFrameCount, ma_uint64* pOutputFrameCount) {
+        *pOutputFrameCount = ((const AudioResampler*)pBackend)->getExpectedOutputFrames(inputFrameCount);
+        return MA_SUCCESS;
+    }
+
+    static ma_result onReset(void*, ma_resampling_backend* pBackend) {
+        ((AudioResampler*)pBackend)->reset();
+        return MA_SUCCESS;
+    }
+
+    static inline ma_resampling_backend_vtable vtable = {
+        onGetHeapSize,
+        onInit,
+        onUninit,
+        onProcess,
+        nullptr, // no rate changes after init
+        onGetInputLatency,
+        onGetOutputLatency,
+        onGetRequiredInputFrameCount,
+        onGetExpectedOutputFrameCount,
+        onReset
+    };
+
+public:
+    /// <summary>
+    /// Points a miniaudio resampler config (ma_data_converter_config::resampling,
+    /// ma_decoder_config::resampling) at the given tier.
+    /// </summary>
+    static void configure(ma_resampler_config& config, AudioResampleQuality quality) {
+        if (quality == AudioResampleQuality::Linear) {
+            config.algorithm = ma_resample_algorithm_linear;
+            config.pBackendVTable = nullptr;
+            config.pBackendUserData = nullptr;
+            return;
+        }
+
+        config.algorithm = ma_resample_algorithm_custom;
+        config.pBackendVTable = &vtable;
+        config.pBackendUserData = (void*)getTier(quality);
+    }
+
+    /// <summary>
+    /// Builds the filter table for a conversion ahead of time, so the first converter
+    /// initialized for it does not pay for it (tens of microseconds to a few milliseconds).
+    /// </summary>
+    static void prepare(AudioResampleQuality quality, ma_uint32 sampleRateIn, ma_uint32 sampleRateOut) {
+        if (quality == AudioResampleQuality::Linear || sampleRateIn == 0 || sampleRateOut == 0) return;
+        const ma_uint32 divisor = gcd(sampleRateIn, sampleRateOut);
+        bool isInterpolated = false;
+        acquireTable(*getTier(quality), sampleRateOut / divisor, sampleRateIn / divisor, isInterpolated);
+    }
+
+    /// <summary>
+    /// Builds the tables of the common conversions: 44.1k <-> 48k and 48k <-> 16k.
+    /// </summary>
+    static void prepareCommon(AudioResampleQuality quality) {
+        prepare(quality, 44100, 48000);
+        prepare(quality, 48000, 44100);
+        prepare(quality, 48000, 16000);
+        prepare(quality, 16000, 48000);
+    }
+
+    static const char* getQualityName(AudioResampleQuality quality) {
+        switch (quality) {
+        case AudioResampleQuality::Linear: return "linear";
+        case AudioResampleQuality::Sinc: return "sinc";
+        case AudioResampleQuality::Offline: return "offline";
+        }
+        return "unknown";
+    }
+};
@@ -0,0 +1,278 @@
+#pragma once
+
+#include "../include.h"
+#include "./AudioFormat.h"
+
+#ifndef SOUNDIO_CACHE_LINE_SIZE
+    #define SOUNDIO_CACHE_LINE_SIZE 64
+#endif
+
+// Which implementation backs an endpoint ring.
+// - Miniaudio: ma_pcm_rb (default).
+// - LockFree: AudioFrameRing, padded SPSC ring with two-span access.
+enum class AudioRingBackend {
+    Miniaudio,
+    LockFree
+};
+
+// Up to two contiguous regions of ring memory, second is only used when the range wraps.
+struct AudioRingSpans {
+    void* first = nullptr;
+    ma_uint32 firstFrames = 0;
+    void* second = nullptr;
+    ma_uint32 secondFrames = 0;
+
+    ma_uint32 totalFrames() const { return firstFrames + secondFrames; }
+};
+
+// AudioFrameRing:
+// - Single producer, single consumer, lock-free frame FIFO.
+// - Capacity is a power of two, indices run freely and are masked on access.
+// - Write and read indices live on separate cache lines, each side keeps a cached
+//   copy of the opposite index and only reloads it when it looks full/empty. They are
+//   padded apart rather than aligned: rings are members of endpoints, which are virtual
+//   bases, and compilers misplace over-aligned virtual bases.
+// - The usable size can be lower than the capacity (limitFrames) so rounding up
+//   to a power of two does not add latency.
+
+class AudioFrameRing {
+private:
+    ma_uint8 leadingPadding[SOUNDIO_CACHE_LINE_SIZE];
+
+    // producer side
+    std::atomic<ma_uint32> writeIndex{ 0 };
+    ma_uint32 cachedReadIndex = 0;
+    ma_uint8 producerPadding[SOUNDIO_CACHE_LINE_SIZE - 2 * sizeof(ma_uint32)];
+
+    // consumer side
+    std::atomic<ma_uint32> readIndex{ 0 };
+    ma_uint32 cachedWriteIndex = 0;
+    ma_uint8 consumerPadding[SOUNDIO_CACHE_LINE_SIZE - 2 * sizeof(ma_uint32)];
+
+    // shared, read-only after init
+    ma_uint8* buffer = nullptr;
+    ma_uint32 capacityFrames = 0;
+    ma_uint32 limitFrames = 0;
+    ma_uint32 mask = 0;
+    ma_uint32 frameSize = 0;
+
+    static ma_uint32 nextPowerOfTwo(ma_uint32 value) {
+        ma_uint32 result = 1;
+        while (result < value) result <<= 1;
+        return result;
+    }
+
+    void fillSpans(ma_uint32 index, ma_uint32 frames, AudioRingSpans* spans) const {
+        const ma_uint32 offset = index & mask;
+        const ma_uint32 firstFrames = std::min(frames, capacityFrames - offset);
+
+        spans->first = buffer + (size_t)offset * frameSize;
+        spans->firstFrames = firstFrames;
+        spans->second = firstFrames < frames ? buffer : nullptr;
+        spans->secondFrames = frames - firstFrames;
+    }
+
+public:
+    AudioFrameRing() = default;
+    ~AudioFrameRing() { uninit(); }
+
+    AudioFrameRing(const AudioFrameRing&) = delete;
+    AudioFrameRing& operator=(const AudioFrameRing&) = delete;
+
+    ma_result init(ma_uint32 bytesPerFrame, ma_uint32 frames) {
+        uninit();
+        if (bytesPerFrame == 0 || frames == 0 || frames > 0x40000000) return MA_INVALID_ARGS;
+
+        capacityFrames = nextPowerOfTwo(frames);
+        limitFrames = frames;
+        mask = capacityFrames - 1;
+        frameSize = bytesPerFrame;
+
+        buffer = (ma_uint8*)ma_aligned_malloc((size_t)capacityFrames * frameSize, SOUNDIO_CACHE_LINE_SIZE, nullptr);
+        if (buffer == nullptr) {
+            capacityFrames = limitFrames = mask = frameSize = 0;
+            return MA_OUT_OF_MEMORY;
+        }
+
+        memset(buffer, 0, (size_t)capacityFrames * frameSize);
+        reset();
+        return MA_SUCCESS;
+    }
+
+    void uninit() {
+        if (buffer != nullptr) ma_aligned_free(buffer, nullptr);
+        buffer = nullptr;
+        capacityFrames = limitFrames = mask = frameSize = 0;
+        reset();
+    }
+
+    // Not thread safe, only call while neither side is active
+    void reset() {
+        writeIndex.store(0, std::memory_order_relaxed);
+        readIndex.store(0, std::memory_order_relaxed);
+        cachedReadIndex = 0;
+        cachedWriteIndex = 0;
+    }
+
+    ma_uint32 getCapacity() const { return limitFrames; }
+    ma_uint32 getFrameSize() const { return frameSize; }
+
+    // Observers, safe from any thread
+    ma_uint32 availableRead() const {
+        return writeIndex.load(std::memory_order_acquire) - readIndex.load(std::memory_order_acquire);
+    }
+    ma_uint32 availableWrite() const { return limitFrames - availableRead(); }
+
+    // PRODUCER
+    ma_uint32 acquireWrite(ma_uint32 frames, AudioRingSpans* spans) {
+        const ma_uint32 write = writeIndex.load(std::memory_order_relaxed);
+
+        ma_uint32 writable = limitFrames - (write - cachedReadIndex);
+        if (writable < frames) {
+            cachedReadIndex = readIndex.load(std::memory_order_acquire);
+            writable = limitFrames - (write - cachedReadIndex);
+        }
+
+        frames = std::min(frames, writable);
+        fillSpans(write, frames, spans);
+        return frames;
+    }
+
+    void commitWrite(ma_uint32 frames) {
+        writeIndex.store(writeIndex.load(std::memory_order_relaxed) + frames, std::memory_order_release);
+    }
+
+    ma_uint32 write(const void* pData, ma_uint32 frames) {
+        AudioRingSpans spans;
+        frames = acquireWrite(frames, &spans);
+        if (frames == 0) return 0;
+
+        memcpy(spans.first, pData, (size_t)spans.firstFrames * frameSize);
+        if (spans.secondFrames > 0)
+            memcpy(spans.second, (const ma_uint8*)pData + (size_t)spans.firstFrames * frameSize, (size_t)spans.secondFrames * frameSize);
+
+        commitWrite(frames);
+        return frames;
+    }
+
+    // CONSUMER
+    ma_uint32 acquireRead(ma_uint32 frames, AudioRingSpans* spans) {
+        const ma_uint32 read = readIndex.load(std::memory_order_relaxed);
+
+        ma_uint32 readable = cachedWriteIndex - read;
+        if (readable < frames) {
+            cachedWriteIndex = writeIndex.load(std::memory_order_acquire);
+            readable = cachedWriteIndex - read;
+        }
+
+        frames = std::min(frames, readable);
+        fillSpans(read, frames, spans);
+        return frames;
+    }
+
+    void commitRead(ma_uint32 frames) {
+        readIndex.store(readIndex.load(std::memory_order_relaxed) + frames, std::memory_order_release);
+    }
+
+    ma_uint32 read(void* pOut, ma_uint32 frames) {
+        AudioRingSpans spans;
+        frames = acquireRead(frames, &spans);
+        if (frames == 0) return 0;
+
+        memcpy(pOut, spans.first, (size_t)spans.firstFrames * frameSize);
+        if (spans.secondFrames > 0)
+            memcpy((ma_uint8*)pOut + (size_t)spans.firstFrames * frameSize, spans.second, (size_t)spans.secondFrames * frameSize);
+
+        commitRead(frames);
+        return frames;
+    }
+};
+
+// AudioRing:
+// - Frame FIFO used by endpoints, backed by ma_pcm_rb or AudioFrameRing.
+// - ma_pcm_rb only hands out one contiguous region per acquire, so the second
+//   span stays empty with that backend.
+// - AudioFrameRing is over-aligned, it is kept on the heap so endpoints are not.
+
+class AudioRing {
+private:
+    AudioRingBackend backend = AudioRingBackend::Miniaudio;
+    ma_pcm_rb pcmRing{};
+    std::unique_ptr<AudioFrameRing> frameRing;
+    bool isInitialized = false;
+
+public:
+    AudioRing() = default;
+    ~AudioRing() { uninit(); }
+
+    AudioRing(const AudioRing&) = delete;
+    AudioRing& operator=(const AudioRing&) = delete;
+
+    ma_result init(const AudioFormat& format, ma_uint32 frames, AudioRingBackend ringBackend = AudioRingBackend::Miniaudio) {
+        uninit();
+        backend = ringBackend;
+
+        ma_result result = MA_SUCCESS;
+        if (backend == AudioRingBackend::LockFree) {
+            if (!frameRing) frameRing = std::make_unique<AudioFrameRing>();
+            result = frameRing->init(format.frameSizeInBytes(), frames);
+        }
+        else result = ma_pcm_rb_init(format.toMaFormat(), format.channels, frames, nullptr, nullptr, &pcmRing);
+
+        isInitialized = result == MA_SUCCESS;
+        return result;
+    }
+
+    void uninit() {
+        if (!isInitialized) return;
+
+        if (backend == AudioRingBackend::LockFree) frameRing->uninit();
+        else ma_pcm_rb_uninit(&pcmRing);
+        isInitialized = false;
+    }
+
+    bool isReady() const { return isInitialized; }
+    AudioRingBackend getBackend() const { return backend; }
+
+    ma_uint32 availableRead() {
+        if (!isInitialized) return 0;
+        return backend == AudioRingBackend::LockFree ? frameRing->availableRead() : ma_pcm_rb_available_read(&pcmRing);
+    }
+
+    ma_uint32 availableWrite() {
+        if (!isInitialized) return 0;
+        return backend == AudioRingBackend::LockFree ? frameRing->availableWrite() : ma_pcm_rb_available_write(&pcmRing);
+    }
+
+    ma_uint32 acquireWrite(ma_uint32 frames, AudioRingSpans* spans) {
+        *spans = AudioRingSpans();
+        if (!isInitialized) return 0;
+        if (backend == AudioRingBackend::LockFree) return frameRing->acquireWrite(frames, spans);
+
+        if (ma_pcm_rb_acquire_write(&pcmRing, &frames, &spans->first) != MA_SUCCESS) return 0;
+        spans->firstFrames = frames;
+        return frames;
+    }
+
+    void commitWrite(ma_uint32 frames) {
+        if (!isInitialized) return;
+        if (backend == AudioRingBackend::LockFree) frameRing->commitWrite(frames);
+        else ma_pcm_rb_commit_write(&pcmRing, frames);
+    }
+
+    ma_uint32 acquireRead(ma_uint32 frames, AudioRingSpans* spans) {
+        *spans = AudioRingSpans();
+        if (!isInitialized) return 0;
+        if (backend == AudioRingBackend::LockFree) return frameRing->acquireRead(frames, spans);
+
+        if (ma_pcm_rb_acquire_read(&pcmRing, &frames, &spans->first) != MA_SUCCESS) return 0;
+        spans->firstFrames = frames;
+        return frames;
+    }
+
+    void commitRead(ma_uint32 frames) {
+        if (!isInitialized) return;
+        if (backend == AudioRingBackend::LockFree) frameRing->commitRead(frames);
+        else ma_pcm_rb_commit_read(&pcmRing, frames);
+    }
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "../include.h"
+
+// AudioScratch:
+// - Preallocated byte arena used by the real-time path instead of temporary vectors.
+// - reserve() is called off the audio thread (on renegotiation).
+// - acquire() is called from the audio thread; it only touches the heap when a block
+//   is larger than what was reserved, and every such growth is counted.
+
+class AudioScratch {
+private:
+    std::vector<ma_uint8> storage;
+    std::atomic<ma_uint64>* growCounter = nullptr;
+
+public:
+    AudioScratch() = default;
+    explicit AudioScratch(std::atomic<ma_uint64>* growCounter) : growCounter(growCounter) {}
+
+    void reserve(size_t bytes) {
+        if (storage.size() < bytes)
+            storage.resize(bytes);
+    }
+
+    void* acquire(size_t bytes) {
+        if (storage.size() < bytes) {
+            if (growCounter) growCounter->fetch_add(1, std::memory_order_relaxed);
+            storage.resize(bytes);
+        }
+        return storage.data();
+    }
+
+    void release() {
+        std::vector<ma_uint8>().swap(storage);
+    }
+
+    size_t capacity() const { return storage.size(); }
+};
@@ -0,0 +1,244 @@
+#pragma once
+
+#include "../include.h"
+
+// AudioSeekIndex:
+// - Seek table of an MP3: evenly spaced PCM frames mapped to the byte offset of an MP3 frame a few
+//   frames earlier, plus how many frames to decode and drop to rebuild the bit reservoir there.
+// - Bound to a decoder, a seek jumps to the closest point and decodes at most one interval forward,
+//   sample accurate. Without it an MP3 seek decodes from the start of the file.
+// - Built by scanning frame headers (no synthesis), cancellable, and storable in a sidecar file
+//   that is only trusted while the file's size and modification time match.
+// - FLAC seeks through its own seek table or by bisection and WAV seeks are offsets, neither needs one.
+
+class AudioSeekIndex {
+private:
+    static constexpr char sidecarMagic[8] = { 'S', 'I', 'O', 'S', 'E', 'E', 'K', '1' };
+    static constexpr size_t sidecarHeaderBytes = sizeof(sidecarMagic) + 8 + 8 + 8 + 4 + 4;
+    static constexpr size_t sidecarPointBytes = 8 + 8 + 2 + 2;
+
+#if defined(MA_HAS_MP3)
+    using SeekPoint = ma_dr_mp3_seek_point;
+#else
+    struct SeekPoint {
+        ma_uint64 seekPosInBytes;
+        ma_uint64 pcmFrameIndex;
+        ma_uint16 mp3FramesToDiscard;
+        ma_uint16 pcmFramesToDiscard;
+    };
+#endif
+
+    std::vector<SeekPoint> points;
+    ma_uint64 sourceBytes = 0;
+    ma_int64 sourceModified = 0;
+    ma_uint64 frameCount = 0;
+    ma_uint32 sampleRate = 0;
+
+    // The scan reads the encoded bytes from memory and stops early once cancelled
+    struct ScanSource {
+        const ma_uint8* data;
+        size_t size;
+        size_t cursor;
+        const std::atomic<bool>* cancelled;
+    };
+
+    static size_t onScanRead(void* pUserData, void* pBufferOut, size_t bytesToRead) {
+        ScanSource* source = (ScanSource*)pUserData;
+        if (source->cancelled != nullptr && source->cancelled->load(std::memory_order_relaxed)) return 0;
+
+        const size_t bytes = std::min(bytesToRead, source->size - source->cursor);
+        memcpy(pBufferOut, source->data + source->cursor, bytes);
+        source->cursor += bytes;
+        return bytes;
+    }
+
+#if defined(MA_HAS_MP3)
+    static ma_bool32 onScanSeek(void* pUserData, int offset, ma_dr_mp3_seek_origin origin) {
+        ScanSource* source = (ScanSource*)pUserData;
+        const ma_int64 base = origin == ma_dr_mp3_seek_origin_start ? 0 : (ma_int64)source->cursor;
+        const ma_int64 position = base + offset;
+        if (position < 0 || position > (ma_int64)source->size) return MA_FALSE;
+        source->cursor = (size_t)position;
+        return MA_TRUE;
+    }
+#endif
+
+    template<typename T> static bool readValue(FILE* file, T& value) { return fread(&value, sizeof(T), 1, file) == 1; }
+    template<typename T> static bool writeValue(FILE* file, const T& value) { return fwrite(&value, sizeof(T), 1, file) == 1; }
+
+public:
+    /// <summary>
+    /// Whether decoder reads a format the index can speed up (MP3).
+    /// </summary>
+    static bool isIndexable(const ma_decoder& decoder) {
+#if defined(MA_HAS_MP3)
+        return decoder.pBackendVTable == &g_ma_decoding_backend_vtable_mp3;
+#else
+        (void)decoder;
+        return false;
+#endif
+    }
+
+    /// <summary>
+    /// The file's size and modification time, what a sidecar is checked against.
+    /// </summary>
+    static bool getFileSignature(const std::string& path, ma_uint64& bytes, ma_int64& modified) {
+        std::error_code error;
+        bytes = (ma_uint64)std::filesystem::file_size(path, error);
+        if (error) return false;
+
+        const auto time = std::filesystem::last_write_time(path, error);
+        if (error) return false;
+        modified = (ma_int64)time.time_since_epoch().count();
+        return true;
+    }
+
+    static std::string getSidecarPath(const std::string& path) { return path + ".seekindex"; }
+
+    /// <summary>
+    /// Scans the MP3 at pData, one seek point every intervalMS. Returns MA_CANCELLED once cancelled turns true.
+    /// </summary>
+    ma_result build(const void* pData, size_t bytes, ma_uint32 intervalMS, const std::atomic<bool>* cancelled = nullptr) {
+        clear();
+#if defined(MA_HAS_MP3)
+        if (pData == nullptr || bytes == 0) return MA_INVALID_ARGS;
+
+        ScanSource source = { (const ma_uint8*)pData, bytes, 0, cancelled };
+        ma_dr_mp3 mp3;
+        if (!ma_dr_mp3_init(&mp3, onScanRead, onScanSeek, &source, nullptr)) return MA_INVALID_FILE;
+
+        ma_uint64 mp3Frames = 0;
+        ma_uint64 pcmFrames = 0;
+        ma_result result = MA_SUCCESS;
+        if (!ma_dr_mp3_get_mp3_and_pcm_frame_count(&mp3, &mp3Frames, &pcmFrames) || pcmFrames == 0)
+            result = MA_INVALID_FILE;
+
+        if (result == MA_SUCCESS) {
+            const ma_uint64 intervalFrames = std::max<ma_uint64>((ma_uint64)mp3.sampleRate * std::max<ma_uint32>(intervalMS, 1) / 1000, 1);
+            ma_uint32 count = (ma_uint32)std::clamp<ma_uint64>(pcmFrames / intervalFrames, 1, UINT32_MAX - 1);
+            points.resize(count);
+
+            if (ma_dr_mp3_calculate_seek_points(&mp3, &count, points.data())) {
+                points.resize(count);
+                frameCount = pcmFrames;
+                sampleRate = mp3.sampleRate;
+                sourceBytes = bytes;
+            }
+            else result = MA_INVALID_FILE;
+        }
+        ma_dr_mp3_uninit(&mp3);
+
+        // a cancelled scan looks like a short file, keep none of it
+        if (cancelled != nullptr && cancelled->load(std::memory_order_relaxed)) result = MA_CANCELLED;
+        if (result != MA_SUCCESS) clear();
+        return result;
+#else
+        (void)pData; (void)bytes; (void)intervalMS; (void)cancelled;
+        return MA_NOT_IMPLEMENTED;
+#endif
+    }
+
+    /// <summary>
+    /// Stamps the index with the file it was built from, checked by load().
+    /// </summary>
+    void setSourceModified(ma_int64 modified) { sourceModified = modified; }
+
+    /// <summary>
+    /// Writes the index to path (a temporary file renamed over it, readers never see half of one).
+    /// </summary>
+    ma_result save(const std::string& path) const {
+        if (!isReady()) return MA_INVALID_OPERATION;
+
+        const std::string temporary = path + ".tmp";
+        FILE* file = fopen(temporary.c_str(), "wb");
+        if (file == nullptr) return MA_ACCESS_DENIED;
+
+        const ma_uint32 count = (ma_uint32)points.size();
+        bool ok = fwrite(sidecarMagic, sizeof(sidecarMagic), 1, file) == 1
+            && writeValue(file, sourceBytes) && writeValue(file, sourceModified)
+            && writeValue(file, frameCount) && writeValue(file, sampleRate) && writeValue(file, count);
+        for (const SeekPoint& point : points) {
+            if (!ok) break;
+            ok = writeValue(file, point.seekPosInBytes) && writeValue(file, point.pcmFrameIndex)
+                && writeValue(file, point.mp3FramesToDiscard) && writeValue(file, point.pcmFramesToDiscard);
+        }
+        ok = fclose(file) == 0 && ok;
+
+        std::error_code error;
+        if (ok) std::filesystem::rename(temporary, path, error);
+        if (!ok || error) {
+            std::filesystem::remove(temporary, error);
+            return MA_IO_ERROR;
+        }
+        return MA_SUCCESS;
+    }
+
+    /// <summary>
+    /// Reads an index save() wrote for a file of expectedBytes modified at expectedModified.
+    /// </summary>
+    /// <returns>MA_DOES_NOT_EXIST without a sidecar, MA_INVALID_DATA when it is stale or damaged</returns>
+    ma_result load(const std::string& path, ma_uint64 expectedBytes, ma_int64 expectedModified) {
+        clear();
+        std::error_code error;
+        const ma_uint64 sidecarBytes = (ma_uint64)std::filesystem::file_size(path, error);
+        if (error) return MA_DOES_NOT_EXIST;
+
+        FILE* file = fopen(path.c_str(), "rb");
+        if (file == nullptr) return MA_DOES_NOT_EXIST;
+
+        char magic[sizeof(sidecarMagic)];
+        ma_uint32 count = 0;
+        bool ok = fread(magic, sizeof(magic), 1, file) == 1 && memcmp(magic, sidecarMagic, sizeof(magic)) == 0
+            && readValue(file, sourceBytes) && readValue(file, sourceModified)
+            && readValue(file, frameCount) && readValue(file, sampleRate) && readValue(file, count)
+            && sourceBytes == expectedBytes && sourceModified == expectedModified && count > 0
+            // a damaged count must not size the table: it can't exceed the records stored nor the frames
+            && sidecarBytes >= sidecarHeaderBytes && count <= (sidecarBytes - sidecarHeaderBytes) / sidecarPointBytes
+            && count <= frameCount;
+
+        if (ok) {
+            points.resize(count);
+            for (SeekPoint& point : points) {
+                ok = readValue(file, point.seekPosInBytes) && readValue(file, point.pcmFrameIndex)
+                    && readValue(file, point.mp3FramesToDiscard) && readValue(file, point.pcmFramesToDiscard)
+                    && point.seekPosInBytes < sourceBytes && point.pcmFrameIndex < frameCount;
+                if (!ok) break;
+            }
+        }
+        fclose(file);
+
+        if (!ok) {
+            clear();
+            return MA_INVALID_DATA;
+        }
+        return MA_SUCCESS;
+    }
+
+    /// <summary>
+    /// Seeks of decoder go through the index from now on. The index must outlive the decoder
+    /// and stay unchanged. False when decoder does not read an MP3.
+    /// </summary>
+    bool bind(ma_decoder& decoder) {
+#if defined(MA_HAS_MP3)
+        if (!isReady() || !isIndexable(decoder)) return false;
+        ma_mp3* mp3 = (ma_mp3*)decoder.pBackend;
+        return ma_dr_mp3_bind_seek_table(&mp3->dr, (ma_uint32)points.size(), points.data()) == MA_TRUE;
+#else
+        (void)decoder;
+        return false;
+#endif
+    }
+
+    void clear() {
+        points.clear();
+        sourceBytes = 0;
+        sourceModified = 0;
+        frameCount = 0;
+        sampleRate = 0;
+    }
+
+    bool isReady() const { return !points.empty(); }
+    size_t getPointCount() const { return points.size(); }
+    ma_uint64 getLengthInFrames() const { return frameCount; }
+    ma_uint32 getSampleRate() const { return sampleRate; }
+};
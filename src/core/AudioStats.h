@@ -0,0 +1,144 @@
+#pragma once
+
+#include "../include.h"
+
+class AudioNode;
+
+// Lowest and highest value seen since the last take(), updated lock-free from any thread.
+class AudioFillRange {
+private:
+    std::atomic<ma_uint32> lowest{ UINT32_MAX };
+    std::atomic<ma_uint32> highest{ 0 };
+
+public:
+    void track(ma_uint32 fill) {
+        ma_uint32 current = lowest.load(std::memory_order_relaxed);
+        while (fill < current && !lowest.compare_exchange_weak(current, fill, std::memory_order_relaxed)) {}
+
+        current = highest.load(std::memory_order_relaxed);
+        while (fill > current && !highest.compare_exchange_weak(current, fill, std::memory_order_relaxed)) {}
+    }
+
+    // Both are 0 when nothing was tracked
+    void read(ma_uint32& outLowest, ma_uint32& outHighest, bool reset) {
+        outLowest = reset ? lowest.exchange(UINT32_MAX, std::memory_order_relaxed) : lowest.load(std::memory_order_relaxed);
+        outHighest = reset ? highest.exchange(0, std::memory_order_relaxed) : highest.load(std::memory_order_relaxed);
+        if (outLowest == UINT32_MAX) outLowest = 0;
+    }
+};
+
+// Snapshot of an endpoint's counters, see AudioEndpoint::getStats() and SoundIO::collectStats().
+struct AudioEndpointStats {
+    const AudioNode* node = nullptr;
+    std::string name;               // device name, empty for other nodes
+
+    ma_uint64 droppedFrames = 0;    // frames a FIFO had no room for (overruns)
+    ma_uint64 shortReads = 0;       // reads that returned fewer frames than asked (underruns)
+    ma_uint64 missingFrames = 0;    // frames those reads lacked
+    ma_uint64 renegotiations = 0;
+
+    // fill levels in frames since the previous snapshot that reset them
+    ma_uint32 inputFillMin = 0;
+    ma_uint32 inputFillMax = 0;
+    ma_uint32 inputCapacity = 0;
+    ma_uint32 outputFillMin = 0;
+    ma_uint32 outputFillMax = 0;
+    ma_uint32 outputCapacity = 0;
+};
+
+// AudioEndpointCounters:
+// - Owned by every endpoint, written from the audio path with relaxed atomics only.
+// - Survives renegotiations, counts since the endpoint was created.
+
+struct AudioEndpointCounters {
+    std::atomic<ma_uint64> droppedFrames{ 0 };
+    std::atomic<ma_uint64> shortReads{ 0 };
+    std::atomic<ma_uint64> missingFrames{ 0 };
+    std::atomic<ma_uint64> renegotiations{ 0 };
+    AudioFillRange inputFill;
+    AudioFillRange outputFill;
+
+    void countDropped(ma_uint32 frames) {
+        if (frames > 0) droppedFrames.fetch_add(frames, std::memory_order_relaxed);
+    }
+
+    void countRead(ma_uint32 requested, ma_uint32 read) {
+        if (read >= requested) return;
+        shortReads.fetch_add(1, std::memory_order_relaxed);
+        missingFrames.fetch_add(requested - read, std::memory_order_relaxed);
+    }
+
+    void snapshot(AudioEndpointStats& out, bool resetFill) {
+        out.droppedFrames = droppedFrames.load(std::memory_order_relaxed);
+        out.shortReads = shortReads.load(std::memory_order_relaxed);
+        out.missingFrames = missingFrames.load(std::memory_order_relaxed);
+        out.renegotiations = renegotiations.load(std::memory_order_relaxed);
+        inputFill.read(out.inputFillMin, out.inputFillMax, resetFill);
+        outputFill.read(out.outputFillMin, out.outputFillMax, resetFill);
+    }
+};
+
+// Snapshot of a file input's decoder timings, see AudioFileInput::getDecodeStats().
+struct AudioDecodeStats {
+    bool isDecodingAhead = false;
+    ma_uint64 decodeCalls = 0;
+    ma_uint64 decodedFrames = 0;
+    double decodeTimeMS = 0.0;   // total time spent inside the decoder
+    double maxDecodeMS = 0.0;    // slowest single read
+    ma_uint64 stalls = 0;        // reads slower than the audio they produced
+    double stallTimeMS = 0.0;    // time those reads went over
+    ma_uint64 starvedReads = 0;  // decode-ahead: consumer reads that emptied the FIFO before the end
+    ma_uint32 readAheadFrames = 0; // decode-ahead: current fill and depth of the output FIFO
+    ma_uint32 readAheadDepth = 0;
+};
+
+// Written by the decoding thread (callback or decode-ahead worker) with relaxed atomics
+struct AudioDecodeCounters {
+    std::atomic<ma_uint64> decodeCalls{ 0 };
+    std::atomic<ma_uint64> decodedFrames{ 0 };
+    std::atomic<ma_uint64> decodeTimeNs{ 0 };
+    std::atomic<ma_uint64> maxDecodeNs{ 0 };
+    std::atomic<ma_uint64> stalls{ 0 };
+    std::atomic<ma_uint64> stallTimeNs{ 0 };
+    std::atomic<ma_uint64> starvedReads{ 0 };
+
+    // A read is a stall when it took longer than the audio it was asked for
+    void record(ma_uint32 requested, ma_uint32 frames, ma_uint64 elapsedNs, ma_uint32 sampleRate) {
+        decodeCalls.fetch_add(1, std::memory_order_relaxed);
+        decodedFrames.fetch_add(frames, std::memory_order_relaxed);
+        decodeTimeNs.fetch_add(elapsedNs, std::memory_order_relaxed);
+
+        ma_uint64 current = maxDecodeNs.load(std::memory_order_relaxed);
+        while (elapsedNs > current && !maxDecodeNs.compare_exchange_weak(current, elapsedNs, std::memory_order_relaxed)) {}
+
+        const ma_uint64 audioNs = sampleRate ? (ma_uint64)requested * 1000000000ull / sampleRate : 0;
+        if (elapsedNs <= audioNs) return;
+        stalls.fetch_add(1, std::memory_order_relaxed);
+        stallTimeNs.fetch_add(elapsedNs - audioNs, std::memory_order_relaxed);
+    }
+
+    void snapshot(AudioDecodeStats& out) const {
+        out.decodeCalls = decodeCalls.load(std::memory_order_relaxed);
+        out.decodedFrames = decodedFrames.load(std::memory_order_relaxed);
+        out.decodeTimeMS = decodeTimeNs.load(std::memory_order_relaxed) / 1e6;
+        out.maxDecodeMS = maxDecodeNs.load(std::memory_order_relaxed) / 1e6;
+        out.stalls = stalls.load(std::memory_order_relaxed);
+        out.stallTimeMS = stallTimeNs.load(std::memory_order_relaxed) / 1e6;
+        out.starvedReads = starvedReads.load(std::memory_order_relaxed);
+    }
+};
+
+// Snapshot of a file output's writer, see AudioFileOutput::getWriteStats().
+struct AudioWriteStats {
+    bool isWritingAsync = false;
+    ma_uint64 writtenFrames = 0;
+    ma_uint64 writes = 0;          // encoder calls
+    double writeTimeMS = 0.0;      // total time spent inside the encoder
+    double maxWriteMS = 0.0;       // slowest single write
+    ma_uint64 overflows = 0;       // pushes that found the writer queue full
+    ma_uint64 droppedFrames = 0;   // DropNewest: frames lost to those overflows
+    ma_uint64 writeThroughFrames = 0; // WriteThrough: frames the pushing thread wrote itself
+    ma_uint32 queuedFrames = 0;
+    ma_uint32 queueCapacity = 0;
+    ma_uint32 batchFrames = 0;
+};
@@ -10,11 +10,39 @@ protected:
         canDrainOutputRing = isSource;
     }
 
+    // Frames pushed are in the produced format (self format unless set), the output ring is in the downstream format
+    bool needsOutputConversion() const {
+        const Pipeline& p = current();
+        return p.hasSelfToOutputConverter && getProducedFormat() != p.outputRingFormat;
+    }
+
+    // Frames to render in the produced format for the consumer to get frameCount,
+    // more or less than asked when the output converter resamples
+    ma_uint32 getRenderFrames(ma_uint32 frameCount) {
+        if (!needsOutputConversion()) return frameCount;
+        return (ma_uint32)current().selfToOutputConverter.getRequiredInputFrames(frameCount);
+    }
+
     void pushToOutputRing(const void* pData, ma_uint32 frameCount) {
-        writeRing(outputRing, outputRingFormat, pData, frameCount);
+        PipelineScope scope(this);
+        if (!needsOutputConversion()) {
+            writeOutputRing(pData, frameCount);
+            return;
+        }
+
+        Pipeline& p = current();
+        ma_uint64 inF = frameCount;
+        ma_uint64 outF = getExpectedOutputFrames(&p.selfToOutputConverter, true, frameCount);
+        void* converted = p.convertScratch.acquire(p.outputRingFormat.frameSizeInBytes((ma_uint32)outF));
+
+        if (p.selfToOutputConverter.process(pData, &inF, converted, &outF) == MA_SUCCESS)
+            writeOutputRing(converted, (ma_uint32)outF);
     }
 
     ma_uint32 pullFromInputRing(void* pOut, ma_uint32 frameCount) {
-        return readRing(inputRing, inputRingFormat, pOut, frameCount);
+        PipelineScope scope(this);
+        Pipeline& p = current();
+        stats.inputFill.track(p.inputRing.availableRead());
+        return readRing(p.inputRing, p.inputRingFormat, pOut, frameCount);
     }
 };
@@ -0,0 +1,335 @@
+#pragma once
+
+#include "../include.h"
+#include "./AudioFormat.h"
+#include "./AudioConverter.h"
+#include "./AudioFile.h"
+#include "../utils/workstealing.h"
+
+// AudioTranscoder:
+// - Converts one file into another format / sample rate: decoder (native format) ->
+//   AudioConverter -> encoder, block by block. No graph, rings or negotiation involved.
+// - Block buffers are kept between jobs, a worker reuses one transcoder for all its jobs.
+//
+// AudioBatchTranscoder:
+// - Runs transcoding jobs on a WorkStealingPool, one transcoder per worker.
+// - Each job has its own progress and result, readable from any thread while it runs.
+// - A failed or cancelled job leaves no partial output behind.
+
+struct AudioTranscodeJob {
+    std::string inputPath;
+    std::string outputPath;
+    AudioFormat format;
+    ma_encoding_format encodingFormat = ma_encoding_format_unknown; // unknown: from the output extension
+    AudioResampleQuality resampleQuality = AudioResampleQuality::Linear; // when format changes the sample rate
+};
+
+enum class AudioTranscodeState {
+    Queued,
+    Running,
+    Done,
+    Failed,
+    Cancelled
+};
+
+struct AudioTranscodeResult {
+    AudioTranscodeState state = AudioTranscodeState::Queued;
+    ma_result result = MA_SUCCESS;
+    ma_uint64 framesRead = 0;    // source frames decoded so far
+    ma_uint64 totalFrames = 0;   // source length, 0 when the decoder can't tell (vorbis)
+    ma_uint64 framesWritten = 0; // target frames encoded
+    double seconds = 0.0;
+
+    // 0..1, 0 while the length is unknown
+    float getProgress() const {
+        if (state == AudioTranscodeState::Done) return 1.0f;
+        return totalFrames > 0 ? (float)std::min(1.0, (double)framesRead / totalFrames) : 0.0f;
+    }
+
+    bool isFinished() const { return state != AudioTranscodeState::Queued && state != AudioTranscodeState::Running; }
+};
+
+class AudioTranscoder : public AudioFile {
+private:
+    AudioConverter converter;
+    std::vector<ma_uint8> decoded;
+    std::vector<ma_uint8> converted;
+
+    // converts and encodes one decoded block, the converter may need several passes.
+    // Nothing past limit output frames is written.
+    ma_result encodeBlock(const AudioFormat& source, const AudioFormat& target, ma_uint32 frames, ma_uint64& framesWritten,
+        ma_uint64 limit = UINT64_MAX) {
+        if (!converter.isReady()) {
+            framesWritten += frames;
+            return writeToFile(decoded.data(), frames);
+        }
+
+        const ma_uint8* in = decoded.data();
+        ma_uint64 remaining = frames;
+        const ma_uint64 capacity = converted.size() / target.frameSizeInBytes();
+        while (remaining > 0) {
+            ma_uint64 inF = remaining;
+            ma_uint64 outF = capacity;
+            ma_result result = converter.process(in, &inF, converted.data(), &outF);
+            if (result != MA_SUCCESS) return result;
+
+            const ma_uint64 kept = std::min(outF, limit > framesWritten ? limit - framesWritten : 0);
+            if (kept > 0) {
+                result = writeToFile(converted.data(), (ma_uint32)kept);
+                if (result != MA_SUCCESS) return result;
+                framesWritten += kept;
+            }
+            if (inF == 0 && outF == 0) break;
+
+            in += source.frameSizeInBytes((ma_uint32)inF);
+            remaining -= inF;
+        }
+        return MA_SUCCESS;
+    }
+
+    // The resampler holds back its latency: pushes it out with silence, up to the exact converted length
+    ma_result flushConverter(const AudioFormat& source, const AudioFormat& target, ma_uint32 blockFrames,
+        ma_uint64 framesRead, ma_uint64& framesWritten) {
+        if (!converter.isReady() || source.sampleRate == target.sampleRate) return MA_SUCCESS;
+
+        const ma_uint64 length = ma_calculate_frame_count_after_resampling(target.sampleRate, source.sampleRate, framesRead);
+        const ma_uint64 padding = converter.getInputLatency() + 1;
+        ma_silence_pcm_frames(decoded.data(), blockFrames, source.toMaFormat(), source.channels);
+
+        for (ma_uint64 pushed = 0; pushed < padding && framesWritten < length; pushed += blockFrames) {
+            ma_result result = encodeBlock(source, target, blockFrames, framesWritten, length);
+            if (result != MA_SUCCESS) return result;
+        }
+        return MA_SUCCESS;
+    }
+
+public:
+    AudioTranscoder() : AudioFile(false, false) {}
+
+    /// <summary>
+    /// Transcodes job, progress is updated after every block. Stops early when cancelled turns true,
+    /// the output is removed when the job does not complete.
+    /// </summary>
+    ma_result transcode(const AudioTranscodeJob& job, ma_uint32 blockFrames,
+        std::atomic<ma_uint64>& framesRead, std::atomic<ma_uint64>& totalFrames,
+        std::atomic<ma_uint64>& framesWritten, const std::atomic<bool>& cancelled
+    ) {
+        blockFrames = std::max<ma_uint32>(blockFrames, 1);
+
+        ma_result result = openFileDecode(job.inputPath, true);
+        if (result != MA_SUCCESS) return result;
+        const AudioFormat source = audioFormat;
+
+        ma_uint64 length = 0;
+        if (ma_decoder_get_length_in_pcm_frames(&decoder, &length) == MA_SUCCESS)
+            totalFrames.store(length, std::memory_order_relaxed);
+
+        result = openFileEncode(job.outputPath, job.format, job.encodingFormat, true);
+        if (result != MA_SUCCESS) {
+            closeDecoder();
+            return result;
+        }
+
+        converter.uninit();
+        if (source != job.format) result = converter.init(source, job.format, job.resampleQuality);
+
+        // grown only, reused by the next jobs
+        decoded.resize(std::max(decoded.size(), (size_t)source.frameSizeInBytes(blockFrames)));
+        if (converter.isReady())
+            converted.resize(std::max(converted.size(),
+                (size_t)job.format.frameSizeInBytes((ma_uint32)converter.getExpectedOutputFrames(blockFrames))));
+
+        ma_uint64 read = 0;
+        ma_uint64 written = 0;
+        while (result == MA_SUCCESS) {
+            if (cancelled.load(std::memory_order_relaxed)) {
+                result = MA_CANCELLED;
+                break;
+            }
+
+            ma_uint32 frames = 0;
+            readFromFile(decoded.data(), blockFrames, &frames);
+            if (frames == 0) break;
+
+            result = encodeBlock(source, job.format, frames, written);
+            read += frames;
+            framesRead.fetch_add(frames, std::memory_order_relaxed);
+            framesWritten.store(written, std::memory_order_relaxed);
+        }
+
+        if (result == MA_SUCCESS) {
+            result = flushConverter(source, job.format, blockFrames, read, written);
+            framesWritten.store(written, std::memory_order_relaxed);
+        }
+
+        closeDecoder();
+        closeEncoder();
+
+        // no partial output
+        if (result != MA_SUCCESS) {
+            std::error_code error;
+            std::filesystem::remove(job.outputPath, error);
+        }
+        return result;
+    }
+};
+
+class AudioBatchTranscoder {
+private:
+    struct Slot {
+        AudioTranscodeJob job;
+        ma_uint32 blockFrames = 0;
+        std::atomic<AudioTranscodeState> state{ AudioTranscodeState::Queued };
+        std::atomic<ma_result> result{ MA_SUCCESS };
+        std::atomic<ma_uint64> framesRead{ 0 };
+        std::atomic<ma_uint64> totalFrames{ 0 };
+        std::atomic<ma_uint64> framesWritten{ 0 };
+        std::atomic<double> seconds{ 0.0 };
+    };
+
+    mutable std::mutex slotsMutex;
+    std::vector<std::unique_ptr<Slot>> slots;
+    std::vector<std::unique_ptr<AudioTranscoder>> transcoders; // one per worker
+    std::atomic<bool> cancelled{ false };
+    std::atomic<size_t> finishedCount{ 0 };
+
+    WorkStealingPool pool; // last: joined before the rest is destroyed
+
+    static AudioTranscodeResult snapshot(const Slot& slot) {
+        AudioTranscodeResult out;
+        out.state = slot.state.load();
+        out.result = slot.result.load();
+        out.framesRead = slot.framesRead.load(std::memory_order_relaxed);
+        out.totalFrames = slot.totalFrames.load(std::memory_order_relaxed);
+        out.framesWritten = slot.framesWritten.load(std::memory_order_relaxed);
+        out.seconds = slot.seconds.load(std::memory_order_relaxed);
+        return out;
+    }
+
+    void runJob(size_t id, Slot& slot, size_t worker) {
+        AudioTranscodeState expected = AudioTranscodeState::Queued;
+        if (!slot.state.compare_exchange_strong(expected, AudioTranscodeState::Running)) return; // cancelled while queued
+
+        const auto start = std::chrono::steady_clock::now();
+        ma_result result = transcoders[worker]->transcode(slot.job, slot.blockFrames,
+            slot.framesRead, slot.totalFrames, slot.framesWritten, cancelled);
+        slot.seconds.store(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+        slot.result.store(result);
+        slot.state.store(result == MA_SUCCESS ? AudioTranscodeState::Done
+            : result == MA_CANCELLED ? AudioTranscodeState::Cancelled : AudioTranscodeState::Failed);
+        finishedCount.fetch_add(1);
+
+        if (onJobFinished) onJobFinished(id, snapshot(slot));
+    }
+
+public:
+    /// <summary>
+    /// Frames decoded per block, applied to the jobs submitted afterwards. Default is 16384.
+    /// </summary>
+    ma_uint32 blockFrames = 16384;
+
+    /// <summary>
+    /// Called from the worker that finished a job (done, failed or cancelled). Set before submitting.
+    /// </summary>
+    std::function<void(size_t id, const AudioTranscodeResult& result)> onJobFinished;
+
+    /// <summary>
+    /// Starts the workers, threadCount 0 uses one per hardware thread.
+    /// </summary>
+    explicit AudioBatchTranscoder(size_t threadCount = 0) : pool(threadCount) {
+        for (size_t i = 0; i < pool.getThreadCount(); i++)
+            transcoders.push_back(std::make_unique<AudioTranscoder>());
+    }
+
+    // Cancels what did not run yet and waits for the running jobs
+    ~AudioBatchTranscoder() {
+        cancel();
+        pool.wait();
+    }
+
+    AudioBatchTranscoder(const AudioBatchTranscoder&) = delete;
+    AudioBatchTranscoder& operator=(const AudioBatchTranscoder&) = delete;
+
+    /// <summary>
+    /// Queues a job.
+    /// </summary>
+    /// <returns>Job id, for getResult()</returns>
+    size_t submit(const AudioTranscodeJob& job) {
+        auto slot = std::make_unique<Slot>();
+        slot->job = job;
+        slot->blockFrames = blockFrames;
+        Slot* raw = slot.get();
+
+        size_t id = 0;
+        {
+            std::lock_guard<std::mutex> lock(slotsMutex);
+            id = slots.size();
+            slots.push_back(std::move(slot));
+        }
+
+        pool.push([this, id, raw](size_t worker) { runJob(id, *raw, worker); });
+        return id;
+    }
+
+    /// <summary>
+    /// Queues every job, ids are consecutive.
+    /// </summary>
+    /// <returns>Id of the first job</returns>
+    size_t submit(const std::vector<AudioTranscodeJob>& jobs) {
+        size_t first = getJobCount();
+        for (const AudioTranscodeJob& job : jobs)
+            submit(job);
+        return first;
+    }
+
+    /// <summary>
+    /// Blocks until every submitted job finished.
+    /// </summary>
+    void wait() { pool.wait(); }
+
+    /// <summary>
+    /// Queued jobs are cancelled, running ones stop at their next block. Later submits run again.
+    /// </summary>
+    void cancel() {
+        {
+            std::lock_guard<std::mutex> lock(slotsMutex);
+            for (auto& slot : slots) {
+                AudioTranscodeState expected = AudioTranscodeState::Queued;
+                if (slot->state.compare_exchange_strong(expected, AudioTranscodeState::Cancelled)) {
+                    slot->result.store(MA_CANCELLED);
+                    finishedCount.fetch_add(1);
+                }
+            }
+        }
+
+        cancelled.store(true);
+        pool.wait();
+        cancelled.store(false);
+    }
+
+    /// <summary>
+    /// Progress and result of one job, safe from any thread.
+    /// </summary>
+    AudioTranscodeResult getResult(size_t id) const {
+        std::lock_guard<std::mutex> lock(slotsMutex);
+        return id < slots.size() ? snapshot(*slots[id]) : AudioTranscodeResult{};
+    }
+
+    std::vector<AudioTranscodeResult> getResults() const {
+        std::lock_guard<std::mutex> lock(slotsMutex);
+        std::vector<AudioTranscodeResult> out;
+        out.reserve(slots.size());
+        for (auto& slot : slots)
+            out.push_back(snapshot(*slot));
+        return out;
+    }
+
+    size_t getJobCount() const {
+        std::lock_guard<std::mutex> lock(slotsMutex);
+        return slots.size();
+    }
+
+    size_t getFinishedCount() const { return finishedCount.load(); }
+    size_t getThreadCount() const { return pool.getThreadCount(); }
+};
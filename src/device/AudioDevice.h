@@ -2,6 +2,13 @@
 
 #include "../include.h"
 #include "../core/AudioEndpoint.h"
+#include "../utils/deviceloops.h"
+
+// AudioDevice:
+// - A speaker or microphone listed by SoundIO::refreshDevices(). Listing is cheap: the native formats
+//   are only probed (ma_context_get_device_info, which opens the device on most backends) when the
+//   device is woken up, its format is asked for (getDeviceFormat()) or a node links to it.
+// - A refresh probes a listed device again only when it changed, or when asked to probe everything.
 
 class AudioDevice : public virtual AudioEndpoint {
 protected:
@@ -17,25 +24,91 @@ protected:
 	
 	static void onDeviceData(ma_device* device, void* out, const void* in, ma_uint32 frames) {
 		auto* self = static_cast<AudioDevice*>(device->pUserData);
-		SI_LOG("onDeviceData called for: " << self->name << ", type=" << self->deviceType);
 		if (!self) return;
+		SI_LOG("onDeviceData called for: " << self->name << ", type=" << self->deviceType);
 		self->dataCallback(device, out, in, frames);
 	}
 
+	// Device types bind their own callback (see bindDataCallback) so miniaudio calls it without virtual dispatch
+	ma_device_data_proc deviceDataProc = &AudioDevice::onDeviceData;
+
+	template <typename TDevice>
+	static void onTypedDeviceData(ma_device* device, void* out, const void* in, ma_uint32 frames) {
+		auto* self = static_cast<TDevice*>(static_cast<AudioDevice*>(device->pUserData));
+		if (!self) return;
+		self->TDevice::dataCallback(device, out, in, frames);
+	}
+
+	template <typename TDevice>
+	void bindDataCallback() { deviceDataProc = &AudioDevice::onTypedDeviceData<TDevice>; }
+
+	// Neighbours negotiate against audioFormat, it has to be known before the link
+	void resolveFormat() override {
+		if (!isProbed) probe();
+	}
+
+	void applyFormat(const AudioFormat& newFormat) {
+		if (deviceFormat == newFormat) return;
+
+		this->deviceFormat = newFormat;
+		this->audioFormat = newFormat;
+		if (this->isNegociationDone)
+			this->renegotiate();
+		SI_LOG("applyFormat: id=" << id << " fmt=" << newFormat.format << " ch=" << newFormat.channels << " sr=" << newFormat.sampleRate);
+	}
+
 public:
 	std::string id;
 	std::string name;
 
-	AudioFormat deviceFormat;
+	AudioFormat deviceFormat; // empty until probed, see getDeviceFormat()
 	ma_device_info deviceInfo;
-	ma_device_type deviceType;
+	ma_device_type deviceType = ma_device_type_playback;
 
 	bool isDefault = false;
+	bool isProbed = false;
+
+	/// <summary>
+	/// Queries the device's native formats and picks the one it is opened with (f32 first, then
+	/// the highest rate and channel count). Renegotiates when the format changed.
+	/// </summary>
+	/// <returns>MA_FORMAT_NOT_SUPPORTED when no native format is usable</returns>
+	ma_result probe() {
+		if (context == nullptr) return MA_INVALID_OPERATION;
+
+		ma_device_info detailedInfo;
+		ma_result result = ma_context_get_device_info(context, deviceType, &deviceInfo.id, &detailedInfo);
+		if (result != MA_SUCCESS) return result;
+
+		ma_format format = ma_format_unknown;
+		ma_uint32 sampleRate = 0;
+		ma_uint32 channels = 0;
+		if (!pickDeviceFormat(detailedInfo, format, sampleRate, channels)) return MA_FORMAT_NOT_SUPPORTED;
+
+		detailedInfo.isDefault = deviceInfo.isDefault; // listing knows the current default
+		this->deviceInfo = detailedInfo;
+		this->isProbed = true;
+		applyFormat(AudioFormat(format, channels, sampleRate));
+		return MA_SUCCESS;
+	}
+
+	/// <summary>
+	/// The format the device is opened with, probed on first use.
+	/// </summary>
+	const AudioFormat& getDeviceFormat() {
+		if (!isProbed) probe();
+		return deviceFormat;
+	}
 
 	bool isAwake = false;
 	virtual ma_result wakeUp() {
 		ma_result result = MA_SUCCESS;
 		this->isAwake = false;
+
+		if (!isProbed) {
+			result = probe();
+			if (result != MA_SUCCESS) return result;
+		}
 		SI_LOG("wakeUp: context=" << context << " backend=" << (context ? context->backend : -999));
 
 		ma_device_config config = ma_device_config_init(deviceType);
@@ -51,7 +124,7 @@ public:
 		}
 
 		config.sampleRate = deviceFormat.sampleRate;
-		config.dataCallback = &AudioDevice::onDeviceData;
+		config.dataCallback = deviceDataProc;
 		config.pUserData = this;
 
 		this->device = std::make_unique<ma_device>();
@@ -94,20 +167,22 @@ public:
 	ma_result ensureAwake() {
 		SI_LOG("ensureAwake called for " << name << ", isAwake=" << isAwake);  return !this->isAwake ? wakeUp() : MA_SUCCESS; }
 
-	void updateDevice(ma_device_info deviceInfo, ma_device_type deviceType, ma_format format, ma_uint32 sampleRate, ma_uint32 channels) {
-		this->name = deviceInfo.name ? std::string(deviceInfo.name) : std::string{};
-		this->deviceInfo = deviceInfo;
-		this->isDefault = (deviceInfo.isDefault != 0);
-		this->deviceType = deviceType;
+	// From a listing: nothing is probed here, a device that changed is probed again on next use
+	// (right away when awake)
+	void updateDevice(const ma_device_info& listedInfo, ma_device_type deviceType) {
+		const std::string listedName = listedInfo.name ? std::string(listedInfo.name) : std::string{};
+		const bool isChanged = listedName != this->name || deviceType != this->deviceType;
 
-		AudioFormat newFormat(format, channels, sampleRate);
-		if (deviceFormat != newFormat) {
-			this->deviceFormat = newFormat;
-			this->audioFormat = newFormat;
-			if (this->isNegociationDone)
-				this->renegotiate();
-			SI_LOG("updateDevice: id=" << id << " default=" << isDefault << " fmt=" << format << " ch=" << channels << " sr=" << sampleRate);
+		this->isDefault = (listedInfo.isDefault != 0);
+		this->deviceType = deviceType;
+		if (isChanged || !isProbed) {
+			this->name = listedName;
+			this->deviceInfo = listedInfo;
+			this->isProbed = false;
 		}
+		this->deviceInfo.isDefault = listedInfo.isDefault;
+
+		if (isChanged && isAwake) probe();
 	}
 
 	AudioDevice(std::string deviceId, ma_context* context) { 
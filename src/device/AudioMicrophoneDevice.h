@@ -3,6 +3,8 @@
 #include "../input/AudioInput.h"
 
 class AudioMicrophoneDevice : public AudioDevice, public virtual AudioInput {
+    friend class AudioDevice;
+
 protected:
     void dataCallback(ma_device* pDevice, void* /*pOutput*/, const void* pInput, ma_uint32 frameCount) override {
         (void)pDevice;
@@ -10,14 +12,23 @@ protected:
         if (!isAwake || !canFillInputRing || pInput == nullptr)
             return;
 
+        // one pipeline for the whole block, a renegotiation is picked up on the next one
+        PipelineScope scope(this);
         receivePCM(pInput, frameCount);
         mixPCM();
     }
 
+    // the block was captured over one device period before this callback
+    double getSourceDelaySeconds() const override {
+        if (!device || device->capture.internalSampleRate == 0) return 0.0;
+        return (double)device->capture.internalPeriodSizeInFrames / device->capture.internalSampleRate;
+    }
+
 public:
     AudioMicrophoneDevice(const std::string& id, ma_context* context)
         : AudioDevice(id, context)
     {
+        bindDataCallback<AudioMicrophoneDevice>();
         canFillInputRing = true;
         canDrainOutputRing = true;
     }
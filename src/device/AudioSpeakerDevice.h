@@ -3,8 +3,11 @@
 #include "./AudioDevice.h"
 #include "../output/AudioOutput.h"
 #include "../core/AudioEndpoint.h"
+#include "../core/AudioGraph.h"
 
 class AudioSpeakerDevice : public AudioDevice, public virtual AudioOutput {
+    friend class AudioDevice;
+
 protected:
     void dataCallback(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount) override {
         (void)pDevice;
@@ -12,13 +15,56 @@ protected:
         if (!isAwake || !isInputSubscribed())
             return;
 
-        pullFromEndpoint(pOutput, frameCount);
+        // one scheduled pass when the nodes upstream can render in blocks, ring pull otherwise
+        if (!graph.render(pOutput, frameCount)) {
+            // never play what a short read left in the buffer
+            ma_uint32 read = pullFromEndpoint(pOutput, frameCount);
+            if (read < frameCount)
+                ma_silence_pcm_frames(audioFormat.frameSizeInBytes(read) + (ma_uint8*)pOutput,
+                    frameCount - read, audioFormat.format, audioFormat.channels);
+        }
+
+        recordMarker();
+    }
+
+    // A marker reached the device: its age plus the device buffering ahead of this block
+    void recordMarker() {
+        if (!hasPendingMarker) return;
+        hasPendingMarker = false;
+
+        double deviceDelay = 0.0;
+        if (device && device->playback.internalSampleRate > 0)
+            deviceDelay = (double)device->playback.internalPeriodSizeInFrames * device->playback.internalPeriods
+                / device->playback.internalSampleRate;
+
+        const double age = (double)(getMarkerClock() - pendingMarker.timeNs) / 1e9;
+        pathLatencies.record(pendingMarker, age + deviceDelay);
     }
 
+    AudioLatencyPaths pathLatencies;
+
 public:
+    /// <summary>
+    /// Render schedule of the nodes feeding this speaker, rebuilt on every link or format change.
+    /// </summary>
+    AudioGraph graph{ this };
+
+    /// <summary>
+    /// End-to-end latency per source with latencyMarkerFrames set, from capture / submission
+    /// to the device output, rings and device buffering included. Safe from any thread.
+    /// </summary>
+    std::vector<AudioPathLatency> getPathLatencies() const { return pathLatencies.summarize(); }
+
+    /// <summary>
+    /// Clears the latency histograms and frees their origin slots, to measure a new window.
+    /// Sources still playing show up again on their next marker.
+    /// </summary>
+    void resetPathLatencies() { pathLatencies.reset(); }
+
     AudioSpeakerDevice(const std::string& id, ma_context* context)
         : AudioDevice(id, context)
     {
+        bindDataCallback<AudioSpeakerDevice>();
         canFillInputRing = false;   // we have an input ring for upstream data
         canDrainOutputRing = false; // speakers don't push further downstream
     }
@@ -12,6 +12,10 @@
 #include <map>
 #include <string>
 #include <vector>
+#include <deque>
+#include <list>
+#include <unordered_map>
+#include <future>
 #include <sstream>
 #include <iomanip>
 #include <memory>
@@ -23,7 +27,11 @@
 #include <algorithm>
 #include <cstring>
 #include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
 #include <filesystem>
+#include <cmath>
 
 #ifndef SOUNDIO_LOG_ENABLED
 	#define SOUNDIO_LOG_ENABLED 0
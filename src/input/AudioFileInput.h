@@ -1,31 +1,604 @@
 #pragma once
 
 #include "../core/AudioFile.h"
+#include "../core/AudioMappedPCM.h"
+#include "../core/AudioAssetCache.h"
+#include "../core/AudioSeekIndex.h"
+#include "../core/AudioStats.h"
 #include "../input/AudioInput.h"
 
+// AudioFileInput:
+// - Decodes a file into the graph, synchronously from the consumer's callback by default.
+// - Decode-ahead mode: a background thread keeps the output FIFO filled up to readAheadMS,
+//   decoding straight into ring memory. The callback then only copies decoded frames, a slow
+//   disk or a heavy codec no longer runs on the audio thread. The consumer wakes the thread once
+//   a chunk of the FIFO is free, offline renders wait for it rather than reading silence.
+// - Decoder timings are counted in both modes, see getDecodeStats().
+// - PCM WAVs (and raw PCM through openRaw) are memory-mapped instead of decoded: frames go from
+//   the mapping straight into the output FIFO or the graph's block, the pipeline converts them
+//   when the consumer wants another format. Seeks only move a cursor.
+// - Shared assets (useAssetCache): the file is decoded once per format into AudioAssetCache, every
+//   input playing it reads the same buffer.
+// - Sources other than a path: a file already in memory (openMemory, PCM WAVs are read in place,
+//   the rest goes through ma_decoder_init_memory), a path inside a ma_vfs, or an AudioFileStream.
+// - MP3s opened from disk or memory get an AudioSeekIndex built on a background thread (or read
+//   from its sidecar), seeks then cost at most one index interval of decoding.
+// - What a pipeline plays (decoder, cached asset) is opened for the standby pipeline on
+//   renegotiation while callbacks keep reading the live one, closed once it is released.
+
 class AudioFileInput : public AudioFile, public virtual AudioInput {
+private:
+    // What one pipeline plays: a decoder in the consumer's format, or in-memory frames
+    struct FileSource : PipelineState {
+        ma_decoder decoder;
+        bool hasDecoder = false;
+        AudioMappedPCM cached;                          // over the shared asset
+        std::shared_ptr<const AudioDecodedAsset> asset;
+        AudioMappedPCM* reader = nullptr;               // in-memory frames being played, nullptr when the decoder reads
+        AudioFormat format;                             // of the frames it reads
+        bool isIndexBound = false;                      // seek index bound to the decoder, by the reading thread
+        bool isDecodedAhead = false;                    // only the decode-ahead thread reads the decoder
+
+        ~FileSource() {
+            if (hasDecoder) ma_decoder_uninit(&decoder);
+        }
+    };
+
+    ma_uint32 lastBlockFrames = 0; // frames decoded into the last block, the rest was padding
+
+    AudioMappedPCM mapped;
+    AudioFormat sourceFormat;                // native format, seeks are in its frames
+    std::atomic<ma_int64> pendingSeek{ -1 }; // applied by the reading thread
+    bool isStreaming = false;                // the last source prepared decodes (user thread)
+    bool isReleasing = false;                // close() is dropping the live source
+
+    AudioDecodeCounters decodeCounters;
+    std::thread decodeThread;
+    std::atomic<bool> isDecodingAhead{ false };
+    std::atomic<bool> stopDecoding{ false };
+    std::atomic<ma_uint32> readAheadFrames{ 0 };
+    std::atomic<ma_uint32> readAheadDepth{ 0 };
+    std::atomic<ma_uint32> readAheadChunk{ 0 };
+    std::mutex decodeMutex;
+    std::condition_variable decodeCondition; // decoder: room to fill, offline reader: frames decoded
+    std::atomic<bool> isDecoderIdle{ false };
+
+    AudioSeekIndex seekIndex;                 // written by the index thread until isIndexReady
+    std::thread indexThread;
+    std::atomic<bool> stopIndexing{ false };
+    std::atomic<bool> isIndexReady{ false };
+
+    // Source of the pipeline this thread holds, the published one off the audio thread
+    FileSource* getSource() const { return static_cast<FileSource*>(current().state.get()); }
+
+    // A native frame at another rate (decoder output, cached asset)
+    ma_uint64 toRate(ma_uint64 frame, ma_uint32 sampleRate) const {
+        if (sourceFormat.sampleRate == 0 || sampleRate == sourceFormat.sampleRate) return frame;
+        return frame * sampleRate / sourceFormat.sampleRate;
+    }
+
+    void applyPendingSeek(FileSource& source) {
+        const ma_int64 frame = pendingSeek.exchange(-1);
+        if (frame < 0) return;
+
+        if (source.hasDecoder && !source.isIndexBound && isIndexReady.load(std::memory_order_acquire))
+            source.isIndexBound = seekIndex.bind(source.decoder);
+
+        AudioMappedPCM* reader = source.reader;
+        ma_result result = MA_INVALID_OPERATION;
+        if (reader != nullptr) result = reader->seek(std::min(toRate((ma_uint64)frame, reader->getFormat().sampleRate), reader->getLengthInFrames()));
+        else if (source.hasDecoder) result = ma_decoder_seek_to_pcm_frame(&source.decoder, toRate((ma_uint64)frame, source.format.sampleRate));
+        if (result == MA_SUCCESS) isInputFinished = false;
+    }
+
+    // Timed decoder (or in-memory) read, from the callback or the decode-ahead thread
+    ma_uint32 decode(FileSource& source, void* pData, ma_uint32 frameCount) {
+        applyPendingSeek(source);
+
+        ma_uint32 framesRead = 0;
+        const auto start = std::chrono::steady_clock::now();
+        if (source.reader != nullptr) {
+            framesRead = source.reader->read(pData, frameCount);
+            bufferStatus = framesRead > 0 ? MA_SUCCESS : MA_AT_END;
+            if (source.reader->isAtEnd()) isInputFinished = true;
+        }
+        else if (source.hasDecoder) readFromDecoder(&source.decoder, pData, frameCount, &framesRead);
+        const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+        decodeCounters.record(frameCount, framesRead, (ma_uint64)elapsed.count(), source.format.sampleRate);
+        return framesRead;
+    }
+
+    // Ring path for in-memory PCM: one copy into the output FIFO, or through the input FIFO
+    // when the pipeline converts
+    void submitMemory(FileSource& source, ma_uint32 frameCount) {
+        applyPendingSeek(source);
+
+        AudioMappedPCM* reader = source.reader;
+        Pipeline& p = current();
+        const bool isDirect = !p.hasSelfToOutputConverter && p.outputRingFormat == source.format;
+        // what the converter needs to hand the consumer frameCount frames
+        const ma_uint32 wanted = p.hasSelfToOutputConverter
+            ? (ma_uint32)p.selfToOutputConverter.getRequiredInputFrames(frameCount) : frameCount;
+
+        const auto start = std::chrono::steady_clock::now();
+        ma_uint32 framesRead = 0;
+        const void* frames = reader->peek(wanted, &framesRead);
+
+        if (framesRead > 0) {
+            if (isDirect)
+                writeOutputRing(frames, framesRead);
+            else {
+                receivePCM(frames, framesRead);
+                mixPCM();
+            }
+            reader->advance(framesRead);
+        }
+        const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        decodeCounters.record(wanted, framesRead, (ma_uint64)elapsed.count(), source.format.sampleRate);
+
+        bufferStatus = framesRead > 0 ? MA_SUCCESS : MA_AT_END;
+        if (reader->isAtEnd()) isInputFinished = true;
+        lastBlockFrames = framesRead;
+    }
+
+    // Decodes one chunk into the output FIFO, false when it is deep enough or the file ended
+    bool fillAhead() {
+        PipelineScope scope(this);
+        Pipeline& p = current();
+        FileSource* source = getSource();
+        if (source == nullptr || !source->hasDecoder) return false;
+        applyPendingSeek(*source); // can revive a finished file
+        if (isInputFinished) return false;
+
+        const ma_uint32 depth = readAheadDepth.load(std::memory_order_relaxed);
+        const ma_uint32 fill = getOutputFill(p);
+        readAheadFrames.store(fill, std::memory_order_relaxed);
+        if (fill >= depth) return false;
+
+        AudioRingSpans spans;
+        const ma_uint32 chunk = readAheadChunk.load(std::memory_order_relaxed);
+        const ma_uint32 writable = acquireOutputWrite(std::min(chunk, depth - fill), &spans);
+        if (writable == 0) return false;
+
+        ma_uint32 written = decode(*source, spans.first, spans.firstFrames);
+        if (written == spans.firstFrames && spans.secondFrames > 0)
+            written += decode(*source, spans.second, spans.secondFrames);
+
+        commitOutputWrite(written);
+        return written > 0;
+    }
+
+    // Sleeps once the FIFO is deep enough, the poll only catches a wakeup sent while going to sleep
+    void decodeAheadLoop(std::chrono::microseconds pollInterval) {
+        while (!stopDecoding.load(std::memory_order_relaxed)) {
+            if (fillAhead()) {
+                decodeCondition.notify_all();
+                continue;
+            }
+            decodeCondition.notify_all(); // ended or full, an offline reader stops waiting
+
+            std::unique_lock<std::mutex> lock(decodeMutex);
+            isDecoderIdle = true;
+            decodeCondition.wait_for(lock, pollInterval, [this] {
+                return !isDecoderIdle.load() || stopDecoding.load(std::memory_order_relaxed);
+            });
+            isDecoderIdle = false;
+        }
+    }
+
+    // Consumer side, after a read: wakes the thread once a whole chunk can be decoded
+    void wakeDecoder(ma_uint32 fill) {
+        if (fill + readAheadChunk.load(std::memory_order_relaxed) > readAheadDepth.load(std::memory_order_relaxed)) return;
+        if (isDecoderIdle.exchange(false)) decodeCondition.notify_all();
+    }
+
+    void startDecodeAhead() {
+        PipelineScope scope(this);
+        Pipeline& p = current();
+        const ma_uint32 rate = p.outputRingFormat.sampleRate;
+        const FileSource* source = getSource();
+        if (source == nullptr || !source->isDecodedAhead || rate == 0) return;
+
+        const ma_uint32 depth = std::min<ma_uint32>(std::max<ma_uint32>(rate * readAheadMS / 1000, 1), p.outputRingFrames);
+        // chunks of a quarter of the depth keep the decoder calls few and the fill smooth
+        const ma_uint32 chunk = std::min(std::max<ma_uint32>(depth / 4, 256), depth);
+        readAheadDepth.store(depth, std::memory_order_relaxed);
+        readAheadChunk.store(chunk, std::memory_order_relaxed);
+        readAheadFrames.store(0, std::memory_order_relaxed);
+
+        // backstop for a missed wakeup, one chunk's duration, 1-50ms
+        const ma_uint64 chunkUs = (ma_uint64)chunk * 1000000 / rate;
+        const std::chrono::microseconds pollInterval(std::clamp<ma_uint64>(chunkUs, 1000, 50000));
+
+        stopDecoding = false;
+        isDecodingAhead = true;
+        decodeThread = std::thread(&AudioFileInput::decodeAheadLoop, this, pollInterval);
+    }
+
+    void stopDecodeAhead() {
+        {
+            std::lock_guard<std::mutex> lock(decodeMutex);
+            stopDecoding = true;
+        }
+        decodeCondition.notify_all();
+        if (decodeThread.joinable()) decodeThread.join();
+        isDecodingAhead = false;
+    }
+
+    // Sidecar when it still matches the file, a scan otherwise (saved when sidecars are on)
+    void indexLoop(std::string path, const void* pData, size_t bytes, bool useSidecar, ma_uint32 intervalMS) {
+        AudioSeekIndex built;
+        ma_uint64 fileBytes = 0;
+        ma_int64 modified = 0;
+        const bool hasSignature = !path.empty() && AudioSeekIndex::getFileSignature(path, fileBytes, modified);
+
+        if (useSidecar && hasSignature
+            && built.load(AudioSeekIndex::getSidecarPath(path), fileBytes, modified) == MA_SUCCESS) {
+            seekIndex = std::move(built);
+            isIndexReady.store(true, std::memory_order_release);
+            return;
+        }
+
+        MappedFile file;
+        if (!path.empty()) {
+            if (file.open(path) != MA_SUCCESS) return;
+            pData = file.data();
+            bytes = file.size();
+        }
+        if (built.build(pData, bytes, intervalMS, &stopIndexing) != MA_SUCCESS) return;
+
+        if (hasSignature) {
+            built.setSourceModified(modified);
+            if (useSidecar) built.save(AudioSeekIndex::getSidecarPath(path));
+        }
+        seekIndex = std::move(built);
+        isIndexReady.store(true, std::memory_order_release);
+    }
+
+    // MP3s on disk or in memory, streams and VFS paths can't be read twice at once
+    void startIndexing() {
+        if (!buildSeekIndex || encodingFormat != ma_encoding_format_mp3) return;
+        if (!isPathSource() && fileData == nullptr) return;
+
+        stopIndexing = false;
+        indexThread = std::thread(&AudioFileInput::indexLoop, this,
+            isPathSource() ? filePath : std::string(), fileData, fileDataBytes, seekIndexSidecar, seekIndexIntervalMS);
+    }
+
+    void stopIndexingThread() {
+        stopIndexing = true;
+        if (indexThread.joinable()) indexThread.join();
+        isIndexReady = false;
+        seekIndex.clear();
+    }
+
 protected:
     void whenOutputSubmitted(void*, ma_uint32 frameCount) override {
-        if (!hasDecoder) return;
+        FileSource* source = getSource();
+        if (source == nullptr) return;
+        if (source->reader != nullptr) {
+            submitMemory(*source, frameCount);
+            return;
+        }
+        if (!source->hasDecoder) return;
 
-        std::vector<uint8_t> buffer(audioFormat.frameSizeInBytes(frameCount));
-        ma_uint32 framesRead = 0;
-        
-        bufferStatus = readFromFile(buffer.data(), frameCount, &framesRead);
+        if (source->isDecodedAhead) {
+            // the read already happened, a FIFO drained before the end means the decoder fell behind
+            PipelineScope scope(this);
+            const ma_uint32 fill = getOutputFill(current());
+            if (isDecodingAhead && !isInputFinished && fill == 0)
+                decodeCounters.starvedReads.fetch_add(1, std::memory_order_relaxed);
+            wakeDecoder(fill);
+            return;
+        }
+
+        void* buffer = current().sourceScratch.acquire(source->format.frameSizeInBytes(frameCount));
+        ma_uint32 framesRead = decode(*source, buffer, frameCount);
+        lastBlockFrames = framesRead;
         if (bufferStatus == MA_SUCCESS && framesRead > 0) {
-            receivePCM(buffer.data(), framesRead);
+            receivePCM(buffer, framesRead);
             mixPCM();
         }
     }
 
-    void whenRenegotiated() override { openDecoder(); }
+    void whenRenegotiated() override { stopDecodeAhead(); }
+
+    // Shared copy in format. A miss is filled from the decoder open() probed the file with, which
+    // is dropped either way: a later renegotiation would find it read to the end.
+    bool acquireCachedAsset(const AudioFormat& format, FileSource& source) {
+        ma_result result = AudioAssetCache::shared().acquire(filePath, format, source.asset, resampleQuality,
+            hasDecoder ? &decoder : nullptr);
+        if (hasDecoder) {
+            ma_decoder_uninit(&decoder);
+            hasDecoder = false;
+        }
+
+        return result == MA_SUCCESS
+            && source.cached.attachMemory(source.asset->format, source.asset->frames.data(), source.asset->frameCount) == MA_SUCCESS;
+    }
+
+    // Opens what the standby pipeline plays, the live source is closed once it is released
+    void preparePipeline(Pipeline& target) override {
+        isStreaming = false;
+        isInputFinished = false;
+        if (isReleasing) return;
+
+        auto source = std::make_unique<FileSource>();
+        const AudioFormat* wanted = getOutputFormat();
+
+        // stored format, or raw PCM (the pipeline converts it): straight from the mapping
+        if (mapped.isOpen() && (wanted == nullptr || *wanted == mapped.getFormat() || !mapped.isWavFile())) {
+            source->reader = &mapped;
+            source->format = mapped.getFormat();
+            pendingSeek = 0;
+        }
+
+        // the shared copy decoded in the consumer's format, files that don't fit are streamed
+        else if (useAssetCache && wanted != nullptr && isPathSource() && acquireCachedAsset(*wanted, *source)) {
+            source->reader = &source->cached;
+            source->format = source->asset->format;
+            pendingSeek = 0;
+        }
+
+        // decoded in the consumer's format (exact resampling, graph-schedulable), from the mapping for WAVs
+        else {
+            source->asset.reset();
+            ma_result result = mapped.isWavFile()
+                ? initOutputDecoder(&source->decoder, mapped.getFileData(), mapped.getFileSize())
+                : initOutputDecoder(&source->decoder);
+            if (result != MA_SUCCESS) {
+                if (result != MA_NOT_CONNECTED) bufferStatus = result;
+                return;
+            }
+
+            source->hasDecoder = true;
+            source->isDecodedAhead = decodeAhead;
+            source->format = AudioFormat(source->decoder.outputFormat, source->decoder.outputChannels, source->decoder.outputSampleRate);
+            isStreaming = true;
+        }
+
+        audioFormat = source->format;
+        target.state = std::move(source);
+    }
+
+    void whenPipelineReady() override { startDecodeAhead(); }
+
+    // Drops the live source once no callback reads it (the decoder may read the stream or the mapping)
+    void releaseSource() {
+        if (getSource() == nullptr) return;
+        isReleasing = true;
+        renegotiate();
+        isReleasing = false;
+    }
+
+    // The read-ahead needs room in the FIFO (called after preparePipeline() opened the decoder)
+    ma_uint32 getOutputBufferMS() const override {
+        return decodeAhead && isStreaming ? std::max(bufferSafetyMS, readAheadMS) : bufferSafetyMS;
+    }
+
+    // Scheduled by a graph: decode straight into the block, silence past the end
+    bool isGraphRenderable() const override { return true; }
+
+    // Offline renders have no deadline: frames the thread has yet to decode are waited for,
+    // silence only pads the block past the end of the file
+    void awaitOutputFrames(ma_uint32 frameCount) override {
+        const FileSource* source = getSource();
+        if (source == nullptr || !source->isDecodedAhead) return;
+
+        Pipeline& p = current();
+        const ma_uint32 wanted = std::min(frameCount, readAheadDepth.load(std::memory_order_relaxed));
+        std::unique_lock<std::mutex> lock(decodeMutex);
+        while (isDecodingAhead && !isInputFinished && getOutputFill(p) < wanted) {
+            isDecoderIdle = false;
+            decodeCondition.notify_all();
+            decodeCondition.wait_for(lock, std::chrono::milliseconds(1));
+        }
+    }
+
+    // Ends once the decoder ran out and what it decoded left the FIFOs
+    bool checkEndOfStream(ma_uint32& tailFrames) override {
+        tailFrames = lastBlockFrames;
+        if (!isInputFinished) return false;
+
+        PipelineScope scope(this);
+        return !hasBufferedFrames(current());
+    }
+
+    void renderGraphBlock(const GraphInput*, size_t, void* pOut, ma_uint32 frames) override {
+        FileSource* source = getSource();
+        const AudioFormat& format = source ? source->format : current().producedFormat;
+        ma_uint32 framesRead = 0;
+        if (source != nullptr && source->isDecodedAhead) {
+            // frames the thread decoded, its markers are dropped: the graph stamps its own
+            Pipeline& p = current();
+            if (isRenderingOffline) awaitOutputFrames(frames);
+            framesRead = readRing(p.outputRing, p.outputRingFormat, pOut, frames);
+            passMarkers(p, nullptr, framesRead);
+            if (isDecodingAhead && framesRead < frames && !isInputFinished)
+                decodeCounters.starvedReads.fetch_add(1, std::memory_order_relaxed);
+            wakeDecoder(getOutputFill(p));
+        }
+        else if (source != nullptr)
+            framesRead = decode(*source, pOut, frames);
+        lastBlockFrames = framesRead;
+
+        if (framesRead < frames)
+            ma_silence_pcm_frames(format.frameSizeInBytes(framesRead) + (ma_uint8*)pOut,
+                frames - framesRead, format.format, format.channels);
+    }
 
 public:
+    /// <summary>
+    /// Decodes on a background thread, the consumer only copies decoded frames.
+    /// Applied on the next renegotiation. Offline renders wait for the thread, they render the same frames.
+    /// </summary>
+    bool decodeAhead = false;
+
+    /// <summary>
+    /// How far ahead of the consumer the decode-ahead thread runs, in ms. Default is 250.
+    /// </summary>
+    ma_uint32 readAheadMS = 250;
+
     AudioFileInput() : AudioFile(true, true) {}
+    ~AudioFileInput() { close(); }
+
+    /// <summary>
+    /// Maps integer / float PCM WAVs instead of decoding them. Applied by open().
+    /// </summary>
+    bool memoryMap = true;
+
+    /// <summary>
+    /// Plays from a copy decoded once in AudioAssetCache::shared() and shared with every input
+    /// playing the same file in the same format. Meant for short, often triggered sounds.
+    /// Applied on the next renegotiation, files on disk only. Set before open(), the decoder open()
+    /// probes the file with then fills the cache instead of a second one.
+    /// </summary>
+    bool useAssetCache = false;
+
+    /// <summary>
+    /// Builds a seek index for MP3s in the background, applied by open(). Not for streams or VFS paths.
+    /// </summary>
+    bool buildSeekIndex = true;
+
+    /// <summary>
+    /// Distance between seek index points in ms, the most a seek decodes past the jump. Default is 500.
+    /// </summary>
+    ma_uint32 seekIndexIntervalMS = 500;
+
+    /// <summary>
+    /// Keeps the seek index of a file on disk next to it (path + ".seekindex"), reopening it skips the scan.
+    /// </summary>
+    bool seekIndexSidecar = false;
+
+    /// <summary>
+    /// Opens a file on disk, or a path inside vfs (an archive, a custom filesystem) when given.
+    /// </summary>
+    ma_result open(const std::string& path, ma_vfs* vfs = nullptr) {
+        close();
+        if (memoryMap && vfs == nullptr && mapped.openWav(path) == MA_SUCCESS) {
+            setSource(path);
+            encodingFormat = ma_encoding_format_wav;
+            audioFormat = sourceFormat = mapped.getFormat();
+            return MA_SUCCESS;
+        }
+
+        // kept open for the asset cache to decode from, rather than opening the file twice
+        setSource(path, vfs);
+        ma_result result = probeDecoder(useAssetCache && vfs == nullptr);
+        if (result == MA_SUCCESS) {
+            sourceFormat = audioFormat;
+            startIndexing();
+        }
+        return result;
+    }
+
+    /// <summary>
+    /// Opens a whole encoded file at pData, which must stay alive and unchanged until close().
+    /// Nothing is copied: PCM WAVs are read in place, other formats are decoded from the buffer.
+    /// </summary>
+    ma_result openMemory(const void* pData, size_t bytes) {
+        close();
+        setSource(pData, bytes);
+        if (mapped.attachWav(pData, bytes) == MA_SUCCESS) {
+            encodingFormat = ma_encoding_format_wav;
+            audioFormat = sourceFormat = mapped.getFormat();
+            return MA_SUCCESS;
+        }
+
+        ma_result result = probeDecoder();
+        if (result == MA_SUCCESS) {
+            sourceFormat = audioFormat;
+            startIndexing();
+        }
+        return result;
+    }
 
-    ma_result open(const std::string& path) { return openFileDecode(path); }
-    void close() { closeDecoder(); }
-    bool isOpen() const { return isDecoderOpen(); }
+    /// <summary>
+    /// Decodes from stream, read on whichever thread decodes and rewound on every renegotiation.
+    /// name is only a hint for the encoding (its extension), the content is probed otherwise.
+    /// </summary>
+    ma_result openStream(std::shared_ptr<AudioFileStream> stream, const std::string& name = "") {
+        close();
+        if (stream == nullptr) return MA_INVALID_ARGS;
+
+        setSource(std::move(stream), name);
+        ma_result result = probeDecoder();
+        if (result == MA_SUCCESS) sourceFormat = audioFormat;
+        return result;
+    }
+
+    /// <summary>
+    /// Opens headerless PCM stored in format, memory-mapped. headerBytes are skipped.
+    /// </summary>
+    ma_result openRaw(const std::string& path, const AudioFormat& format, size_t headerBytes = 0) {
+        close();
+        ma_result result = mapped.openRaw(path, format, headerBytes);
+        if (result != MA_SUCCESS) return result;
+
+        setSource(path);
+        audioFormat = sourceFormat = format;
+        return MA_SUCCESS;
+    }
+
+    void close() {
+        stopDecodeAhead();
+        releaseSource();
+        closeDecoder();
+        stopIndexingThread();
+        mapped.close();
+        clearSource();
+        pendingSeek = -1;
+        bufferStatus = MA_SUCCESS;
+        isInputFinished = false;
+    }
+
+    bool isOpen() const {
+        const FileSource* source = getSource();
+        return (source != nullptr && source->hasDecoder) || mapped.isOpen();
+    }
+    // Read from a memory mapping or caller memory, directly or by a decoder converting from it
+    bool isMapped() const { return mapped.isOpen(); }
+    // Playing a shared asset from AudioAssetCache
+    bool isPlayingCachedAsset() const {
+        const FileSource* source = getSource();
+        return source != nullptr && source->asset != nullptr && source->reader == &source->cached;
+    }
+
+    /// <summary>
+    /// Moves playback to frame (in the file's own sample rate), applied by the next read, sample accurate.
+    /// Free on mapped files, a decoder seek otherwise: bounded by seekIndexIntervalMS on MP3s once
+    /// hasSeekIndex(), from the start of the file before. Frames already queued downstream still play.
+    /// </summary>
+    void seekToFrame(ma_uint64 frame) { pendingSeek = (ma_int64)frame; }
+
+    // The background seek index is ready (MP3s only)
+    bool hasSeekIndex() const { return isIndexReady.load(std::memory_order_acquire); }
 
     bool isFinished() const { return isInputFinished; }
+
+    /// <summary>
+    /// Decoder timings and, in decode-ahead mode, how full the read-ahead is. Safe from any thread.
+    /// </summary>
+    AudioDecodeStats getDecodeStats() const {
+        AudioDecodeStats out;
+        decodeCounters.snapshot(out);
+        out.isDecodingAhead = isDecodingAhead;
+        out.readAheadFrames = readAheadFrames.load(std::memory_order_relaxed);
+        out.readAheadDepth = readAheadDepth.load(std::memory_order_relaxed);
+        return out;
+    }
+
+    /// <summary>
+    /// Clears the decoder counters.
+    /// </summary>
+    void resetDecodeStats() {
+        decodeCounters.decodeCalls = 0;
+        decodeCounters.decodedFrames = 0;
+        decodeCounters.decodeTimeNs = 0;
+        decodeCounters.maxDecodeNs = 0;
+        decodeCounters.stalls = 0;
+        decodeCounters.stallTimeNs = 0;
+        decodeCounters.starvedReads = 0;
+    }
 };
@@ -9,16 +9,44 @@ class AudioInput : public virtual AudioEndpoint {
 public:
     bool isSubscribed() override { return isOutputSubscribed(); }
 
+    /// <summary>
+    /// Feeds this input to an output, can be called for several outputs (fan-out).
+    /// The first output subscribed is the primary one and clocks this input.
+    /// </summary>
     ma_result subscribe(AudioOutput* destination);
     ma_result unsubscribe() { return unsubscribeOutput(); }
+    ma_result unsubscribe(AudioOutput* destination);
+
+    size_t getSubscriberCount() const { return outputNodes.size(); }
+
+    /// <summary>
+    /// Frames an output lost because it could not keep up with the others (see fanoutPolicy).
+    /// </summary>
+    ma_uint64 getDroppedFrames(AudioOutput* destination);
 
     virtual ~AudioInput() = default;
     
     ma_uint32 getAvailableWriteFrames() {
-        return getRingAvailableWrite(&outputRing);
+        return getOutputAvailableWrite();
     }
 };
 
 inline ma_result AudioInput::subscribe(AudioOutput* destination) {
     return subscribeOutput(static_cast<AudioNode*>(destination));
 }
+
+inline ma_result AudioInput::unsubscribe(AudioOutput* destination) {
+    return unsubscribeOutput(static_cast<AudioNode*>(destination));
+}
+
+inline ma_uint64 AudioInput::getDroppedFrames(AudioOutput* destination) {
+    PipelineScope scope(this);
+    Pipeline& p = current();
+    if (!p.isBroadcasting) return 0;
+    return p.outputBroadcast.getDroppedFrames(findSubscriber(p, static_cast<AudioNode*>(destination)));
+}
+
+// needs both classes complete
+inline ma_result AudioOutput::subscribe(AudioInput* source) {
+    return subscribeInput(static_cast<AudioNode*>(source));
+}
@@ -4,10 +4,77 @@
 #include "AudioInput.h"
 
 class AudioStreamInput : public AudioStream, public virtual AudioInput {
+private:
+    bool isStagingWrite = false;
+    ma_uint32 acquiredFrames = 0;
+    Pipeline* writePipeline = nullptr; // leased from acquireWrite() to commitWrite(), spans point into it
+
+    void releaseWritePipeline() {
+        if (writePipeline == nullptr) return;
+        writePipeline->writers.fetch_sub(1);
+        writePipeline = nullptr;
+    }
+
 public:
     AudioStreamInput(const AudioFormat& format) : AudioStream(format, true, false) {}
+    virtual ~AudioStreamInput() { releaseWritePipeline(); }
+
     void submitPCM(const void* pData, ma_uint32 frameCount) {
         if (!canDrainOutputRing) return;
         pushToOutputRing(pData, frameCount);
     }
-};
\ No newline at end of file
+
+    /// <summary>
+    /// Reserves up to frameCount frames for the producer to write in place, in the stream's format.
+    /// When no conversion is needed the spans point straight into the output ring
+    /// (the second span is used when the region wraps), otherwise into a staging block converted on commit.
+    /// The spans stay valid until commitWrite() or the next acquireWrite(), even across a renegotiation:
+    /// the pipeline they belong to is kept aside rather than waited for, and frames committed into it
+    /// once it was replaced are counted as dropped.
+    /// </summary>
+    /// <param name="frameCount">Frames wanted</param>
+    /// <returns>Writable spans, totalFrames() can be lower than requested when the ring is full</returns>
+    AudioRingSpans acquireWrite(ma_uint32 frameCount) {
+        AudioRingSpans spans;
+        acquiredFrames = 0;
+        releaseWritePipeline();
+        if (!canDrainOutputRing || frameCount == 0) return spans;
+
+        PipelineScope scope(this);
+        Pipeline& p = current();
+
+        isStagingWrite = needsOutputConversion();
+        if (!isStagingWrite) {
+            acquiredFrames = acquireOutputWrite(frameCount, &spans);
+        } else {
+            // staging block in the stream's format, bounded by the input frames the ring can take once converted
+            acquiredFrames = std::min(frameCount, getRenderFrames(getOutputAvailableWrite()));
+            spans.first = p.sourceScratch.acquire(audioFormat.frameSizeInBytes(acquiredFrames));
+            spans.firstFrames = acquiredFrames;
+        }
+
+        // taken while the scope still holds p, so a renegotiation swapping it out sees the lease
+        if (acquiredFrames > 0) {
+            writePipeline = &p;
+            writePipeline->writers.fetch_add(1);
+        }
+        return spans;
+    }
+
+    /// <summary>
+    /// Publishes frames written through the spans of the last acquireWrite().
+    /// </summary>
+    /// <param name="frameCount">Frames actually written, at most the acquired amount</param>
+    void commitWrite(ma_uint32 frameCount) {
+        frameCount = std::min(frameCount, acquiredFrames);
+        acquiredFrames = 0;
+        if (frameCount > 0 && writePipeline != nullptr) {
+            PipelineScope scope(this);
+            Pipeline& p = current();
+            if (&p != writePipeline) stats.countDropped(frameCount); // renegotiated meanwhile
+            else if (isStagingWrite) pushToOutputRing(p.sourceScratch.acquire(0), frameCount);
+            else commitOutputWrite(frameCount);
+        }
+        releaseWritePipeline();
+    }
+};
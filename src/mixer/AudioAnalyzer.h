@@ -0,0 +1,354 @@
+#pragma once
+
+#include "./AudioMixer.h"
+#include "../core/AudioRing.h"
+#include "../utils/fft.h"
+#include "../utils/simdmix.h"
+
+// Latest analysis of a stream, copied out by AudioAnalyzer::getAnalysis().
+struct AudioAnalysis {
+    std::vector<float> spectrum; // magnitude per bin, 1.0 = full scale sine
+    float rms = 0.0f;            // over the last hop, every channel
+    float peak = 0.0f;           // over the last hop, every channel
+    float crestFactor = 0.0f;    // peak / rms, 0 on silence
+    ma_uint64 index = 0;         // grows by one with every published analysis
+};
+
+class AudioAnalyzer;
+
+// AudioAnalyzerWorker:
+// - One thread shared by every analyzer, so monitoring many streams costs one thread.
+// - Each pass drains every analyzer's taps, it sleeps when they are all empty.
+// - Never destroyed, analyzers released during static teardown can still unregister.
+
+class AudioAnalyzerWorker {
+private:
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    std::vector<AudioAnalyzer*> analyzers;
+    bool isStarted = false;
+
+    void run();
+
+public:
+    /// <summary>
+    /// How long the worker sleeps when no analyzer had pending frames.
+    /// </summary>
+    std::chrono::milliseconds idleInterval{ 2 };
+
+    static AudioAnalyzerWorker& get() {
+        static AudioAnalyzerWorker* worker = new AudioAnalyzerWorker();
+        return *worker;
+    }
+
+    void add(AudioAnalyzer* analyzer) {
+        std::lock_guard<std::mutex> lock(mutex);
+        analyzers.push_back(analyzer);
+
+        if (!isStarted) {
+            isStarted = true;
+            std::thread([this]() { run(); }).detach();
+        }
+        wakeup.notify_one();
+    }
+
+    // Waits for the current pass, the analyzer is never touched again afterwards
+    void remove(AudioAnalyzer* analyzer) {
+        std::lock_guard<std::mutex> lock(mutex);
+        analyzers.erase(std::remove(analyzers.begin(), analyzers.end(), analyzer), analyzers.end());
+    }
+};
+
+// AudioAnalyzer:
+// - Pass-through node (input -> analyzer -> output), frames go through untouched.
+// - The audio thread only copies each block into per-channel lock-free taps.
+// - Registered with the shared worker only while linked on both sides, an idle analyzer costs nothing.
+// - The shared worker computes, every hopFrames, the Hann windowed magnitude spectrum
+//   of the channel mix over the last fftSize frames, and RMS / peak / crest factor of the hop.
+// - Results are published through a seqlock, readers never block the worker nor the
+//   audio thread, they retry when they raced an update.
+
+class AudioAnalyzer : public AudioMixer {
+    friend class AudioAnalyzerWorker;
+
+private:
+    std::shared_ptr<const AudioFFT> plan;
+    AudioFFT::Work work;
+    ma_uint32 fftSize;
+    ma_uint32 hopFrames;
+
+    // audio thread -> worker
+    std::vector<std::unique_ptr<AudioFrameRing>> taps;
+    std::atomic<ma_uint64> droppedFrames{ 0 };
+    ma_result tapStatus = MA_SUCCESS;
+    bool isRegistered = false; // with the worker, user thread only
+
+    // worker only
+    std::vector<float> hopBlock;   // one hop, planar
+    std::vector<float> monoBlock;  // one hop, channel mix
+    std::vector<float> history;    // last fftSize mono frames, circular
+    std::vector<float> windowed;
+    ma_uint32 historyPosition = 0;
+    ma_uint32 hopProgress = 0;
+    double hopSquares = 0.0;
+    float hopPeak = 0.0f;
+    ma_uint64 analysisIndex = 0;
+
+    // worker -> readers
+    std::atomic<ma_uint32> sequence{ 0 };
+    std::unique_ptr<std::atomic<float>[]> publishedSpectrum;
+    std::atomic<float> publishedRms{ 0.0f };
+    std::atomic<float> publishedPeak{ 0.0f };
+    std::atomic<float> publishedCrest{ 0.0f };
+    std::atomic<ma_uint64> publishedIndex{ 0 };
+
+    static ma_uint32 roundFftSize(ma_uint32 size) {
+        ma_uint32 result = 64;
+        while (result < size && result < (1u << 20)) result <<= 1;
+        return result;
+    }
+
+    ma_uint32 getTapReadable() const {
+        ma_uint32 readable = UINT32_MAX;
+        for (auto& tap : taps) readable = std::min(readable, tap->availableRead());
+        return readable;
+    }
+
+    ma_uint32 getTapWritable() const {
+        ma_uint32 writable = UINT32_MAX;
+        for (auto& tap : taps) writable = std::min(writable, tap->availableWrite());
+        return writable;
+    }
+
+    // Analyzed while frames can flow through, and only when the taps could be allocated
+    void updateRegistration() {
+        const bool wanted = tapStatus == MA_SUCCESS && areBothSubscribed();
+        if (wanted == isRegistered) return;
+
+        isRegistered = wanted;
+        if (wanted) AudioAnalyzerWorker::get().add(this);
+        else AudioAnalyzerWorker::get().remove(this);
+    }
+
+    void appendHistory(const float* mono, ma_uint32 frames) {
+        const ma_uint32 first = std::min(frames, fftSize - historyPosition);
+        memcpy(history.data() + historyPosition, mono, first * sizeof(float));
+        memcpy(history.data(), mono + first, (frames - first) * sizeof(float));
+        historyPosition = (historyPosition + frames) & (fftSize - 1);
+    }
+
+    void publish() {
+        // oldest frame first, windowed
+        const float* window = plan->getWindow();
+        const ma_uint32 first = fftSize - historyPosition;
+        for (ma_uint32 n = 0; n < first; n++)
+            windowed[n] = history[historyPosition + n] * window[n];
+        for (ma_uint32 n = 0; n < historyPosition; n++)
+            windowed[first + n] = history[n] * window[first + n];
+
+        plan->forward(windowed.data(), work);
+
+        const ma_uint32 bins = plan->getBinCount();
+        const float scale = 2.0f / plan->getWindowSum();
+        float* magnitude = work.re.data();
+        const float* imaginary = work.im.data();
+        for (ma_uint32 k = 0; k < bins; k++)
+            magnitude[k] = std::sqrt(magnitude[k] * magnitude[k] + imaginary[k] * imaginary[k]) * scale;
+
+        const ma_uint64 samples = (ma_uint64)hopFrames * inputFormat.channels;
+        const float rms = (float)std::sqrt(hopSquares / (double)samples);
+
+        // odd sequence while writing
+        const ma_uint32 current = sequence.load(std::memory_order_relaxed);
+        sequence.store(current + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (ma_uint32 k = 0; k < bins; k++)
+            publishedSpectrum[k].store(magnitude[k], std::memory_order_relaxed);
+        publishedRms.store(rms, std::memory_order_relaxed);
+        publishedPeak.store(hopPeak, std::memory_order_relaxed);
+        publishedCrest.store(rms > 0.0f ? hopPeak / rms : 0.0f, std::memory_order_relaxed);
+        publishedIndex.store(++analysisIndex, std::memory_order_relaxed);
+
+        sequence.store(current + 2, std::memory_order_release);
+    }
+
+    // Worker thread, returns false when the taps were empty
+    bool analyzePending() {
+        ma_uint32 available = getTapReadable();
+        if (available == 0) return false;
+
+        const ma_uint32 channels = inputFormat.channels;
+        const float mixGain = 1.0f / (float)channels;
+
+        while (available > 0) {
+            const ma_uint32 frames = std::min(available, hopFrames - hopProgress);
+
+            memset(monoBlock.data(), 0, frames * sizeof(float));
+            for (ma_uint32 ch = 0; ch < channels; ch++) {
+                float* plane = hopBlock.data() + (size_t)ch * hopFrames;
+                taps[ch]->read(plane, frames);
+
+                double squares = 0.0;
+                for (ma_uint32 i = 0; i < frames; i++)
+                    squares += plane[i] * plane[i];
+                hopSquares += squares;
+                hopPeak = std::max(hopPeak, peakF32(plane, frames));
+                mixAccumulateF32(monoBlock.data(), plane, mixGain, frames);
+            }
+            appendHistory(monoBlock.data(), frames);
+
+            available -= frames;
+            hopProgress += frames;
+            if (hopProgress < hopFrames) continue;
+
+            publish();
+            hopProgress = 0;
+            hopSquares = 0.0;
+            hopPeak = 0.0f;
+        }
+        return true;
+    }
+
+protected:
+    // Audio thread, in place so the frames are already in out
+    void process(const float* const* in, float* const* out, ma_uint32 frames) override {
+        (void)out;
+        if (tapStatus != MA_SUCCESS) {
+            droppedFrames.fetch_add(frames, std::memory_order_relaxed);
+            return;
+        }
+
+        const ma_uint32 writable = std::min(frames, getTapWritable());
+        for (ma_uint32 ch = 0; ch < inputFormat.channels; ch++)
+            taps[ch]->write(in[ch], writable);
+
+        if (writable < frames)
+            droppedFrames.fetch_add(frames - writable, std::memory_order_relaxed);
+    }
+
+    ma_result handleInputSubscribe(AudioNode* node) override {
+        ma_result result = AudioMixer::handleInputSubscribe(node);
+        updateRegistration();
+        return result;
+    }
+
+    ma_result handleOutputSubscribe(AudioNode* node) override {
+        ma_result result = AudioMixer::handleOutputSubscribe(node);
+        updateRegistration();
+        return result;
+    }
+
+    ma_result handleInputUnsubscribe(AudioNode* node) override {
+        ma_result result = AudioMixer::handleInputUnsubscribe(node);
+        updateRegistration();
+        return result;
+    }
+
+    ma_result handleOutputUnsubscribe(AudioNode* node) override {
+        ma_result result = AudioMixer::handleOutputUnsubscribe(node);
+        updateRegistration();
+        return result;
+    }
+
+public:
+    /// <summary>
+    /// Creates an analyzer, frames are analyzed in f32 with the given channels and sample rate.
+    /// </summary>
+    /// <param name="format">Stream format</param>
+    /// <param name="fftSize">Spectrum size, rounded up to a power of two (64 minimum)</param>
+    /// <param name="hopFrames">Frames between two analyses, half of fftSize when 0</param>
+    AudioAnalyzer(const AudioFormat& format, ma_uint32 fftSize = 2048, ma_uint32 hopFrames = 0)
+        : AudioMixer(format),
+          fftSize(roundFftSize(fftSize))
+    {
+        this->hopFrames = hopFrames == 0 ? this->fftSize / 2 : std::min(hopFrames, this->fftSize);
+
+        plan = AudioFFT::getPlan(this->fftSize);
+        work = plan->makeWork();
+
+        // the worker can fall a few hops behind before frames are dropped
+        const ma_uint32 tapFrames = std::max(this->fftSize * 2, inputFormat.sampleRate / 4);
+        for (ma_uint32 ch = 0; ch < inputFormat.channels && tapStatus == MA_SUCCESS; ch++) {
+            auto tap = std::make_unique<AudioFrameRing>();
+            tapStatus = tap->init(sizeof(float), tapFrames);
+            taps.push_back(std::move(tap));
+        }
+
+        hopBlock.resize((size_t)inputFormat.channels * this->hopFrames);
+        monoBlock.resize(this->hopFrames);
+        history.resize(this->fftSize);
+        windowed.resize(this->fftSize);
+
+        publishedSpectrum = std::make_unique<std::atomic<float>[]>(plan->getBinCount());
+        for (ma_uint32 k = 0; k < plan->getBinCount(); k++)
+            publishedSpectrum[k].store(0.0f, std::memory_order_relaxed);
+    }
+
+    virtual ~AudioAnalyzer() {
+        if (isRegistered) AudioAnalyzerWorker::get().remove(this);
+    }
+
+    /// <summary>
+    /// Copies the latest analysis, safe from any thread and never blocks.
+    /// </summary>
+    /// <param name="out">Receives the analysis, its spectrum is resized to getBinCount()</param>
+    /// <returns>False when nothing was published yet, or when updates kept racing the copy</returns>
+    bool getAnalysis(AudioAnalysis& out) const {
+        const ma_uint32 bins = plan->getBinCount();
+        out.spectrum.resize(bins);
+
+        for (int attempt = 0; attempt < 16; attempt++) {
+            const ma_uint32 before = sequence.load(std::memory_order_acquire);
+            if (before == 0) return false;
+            if (before & 1) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            for (ma_uint32 k = 0; k < bins; k++)
+                out.spectrum[k] = publishedSpectrum[k].load(std::memory_order_relaxed);
+            out.rms = publishedRms.load(std::memory_order_relaxed);
+            out.peak = publishedPeak.load(std::memory_order_relaxed);
+            out.crestFactor = publishedCrest.load(std::memory_order_relaxed);
+            out.index = publishedIndex.load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) == before) return true;
+        }
+        return false;
+    }
+
+    ma_uint32 getFftSize() const { return fftSize; }
+    ma_uint32 getHopFrames() const { return hopFrames; }
+    ma_uint32 getBinCount() const { return plan->getBinCount(); }
+    float getBinFrequency(ma_uint32 bin) const { return (float)bin * inputFormat.sampleRate / fftSize; }
+
+    /// <summary>
+    /// MA_SUCCESS, or why the taps could not be allocated: frames then pass through unanalyzed.
+    /// </summary>
+    ma_result getTapStatus() const { return tapStatus; }
+
+    /// <summary>
+    /// Frames that skipped analysis because the worker fell behind (audio is never affected).
+    /// </summary>
+    ma_uint64 getDroppedFrames() const { return droppedFrames.load(std::memory_order_relaxed); }
+};
+
+inline void AudioAnalyzerWorker::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (true) {
+        if (analyzers.empty()) {
+            wakeup.wait(lock);
+            continue;
+        }
+
+        bool hadFrames = false;
+        for (AudioAnalyzer* analyzer : analyzers)
+            hadFrames |= analyzer->analyzePending();
+
+        if (!hadFrames)
+            wakeup.wait_for(lock, idleInterval);
+    }
+}
@@ -0,0 +1,240 @@
+#pragma once
+
+#include "../core/AudioStream.h"
+#include "../input/AudioInput.h"
+#include "../output/AudioStreamOutput.h"
+#include "../utils/simdmix.h"
+
+// Final stage applied to the summed block.
+// - None: left as is, can go past full scale.
+// - SoftClip: linear up to -6 dBFS, then a cubic curve saturating smoothly at full scale.
+// - Limiter: block peak limiter, instant attack and smoothed release, transparent below its ceiling.
+enum class AudioCombinerClipMode {
+    None,
+    SoftClip,
+    Limiter
+};
+
+// AudioCombiner:
+// - Sums any number of inputs into a single output.
+// - Every input feeds a private port in the combiner's internal f32 format,
+//   so each input is converted once by its own negotiation.
+// - Clocked by its output like a file input: each consumed block renders the next one.
+// - Callbacks mix the source list published with the pipeline, adding or removing an input
+//   renegotiates. A removed input's port is destroyed once no callback holds the old list.
+
+class AudioCombiner : public AudioStream, public virtual AudioInput {
+private:
+    struct Source {
+        AudioInput* input = nullptr;
+        AudioNode* node = nullptr; // input, as the graph names it
+        std::unique_ptr<AudioStreamOutput> port;
+        std::atomic<float> gain{ 1.0f };
+    };
+
+    // What the callbacks mix, immutable once published
+    struct SourceList : PipelineState {
+        std::vector<Source*> sources;
+    };
+
+    std::vector<std::unique_ptr<Source>> sources; // user thread
+    float limiterGain = 1.0f;
+
+    // Sources of the pipeline this thread holds, empty before the first renegotiation
+    const std::vector<Source*>& getMixedSources() {
+        static const std::vector<Source*> none;
+        const auto* list = static_cast<const SourceList*>(current().state.get());
+        return list ? list->sources : none;
+    }
+
+    // The graph's block for a source, nullptr when it pulls its port. The plan lists the sources
+    // in the order they were collected, a removal shifts them until the next rebuild.
+    static const void* findGraphBlock(const GraphInput* inputs, size_t inputCount, size_t hint, const AudioNode* node) {
+        if (hint < inputCount && inputs[hint].node == node) return inputs[hint].block;
+        for (size_t i = 0; i < inputCount; i++)
+            if (inputs[i].node == node) return inputs[i].block;
+        return nullptr;
+    }
+
+    Source* findSource(AudioInput* input) {
+        for (auto& source : sources)
+            if (source->input == input) return source.get();
+        return nullptr;
+    }
+
+    void applyClip(float* buffer, ma_uint32 frames) {
+        const size_t samples = (size_t)frames * audioFormat.channels;
+
+        if (clipMode == AudioCombinerClipMode::SoftClip) {
+            softClipF32(buffer, samples);
+            return;
+        }
+        if (clipMode != AudioCombinerClipMode::Limiter) return;
+
+        // instant attack down to the block's peak, exponential release back to unity
+        const float peak = peakF32(buffer, samples);
+        float targetGain = peak > limiterCeiling ? limiterCeiling / peak : 1.0f;
+        if (targetGain > limiterGain)
+            targetGain = limiterGain + (targetGain - limiterGain) * limiterRelease;
+
+        gainRampF32(buffer, frames, audioFormat.channels, std::min(limiterGain, targetGain), targetGain);
+        limiterGain = targetGain;
+    }
+
+    // Latency markers stop at the port, the mix carries them on
+    void takeMarker(AudioEndpoint* port) {
+        if (!port->hasPendingMarker) return;
+        pendingMarker = port->pendingMarker;
+        hasPendingMarker = true;
+        port->hasPendingMarker = false;
+    }
+
+    // inputs holds the blocks the graph already rendered, sources without one pull their port
+    void mixSources(float* mix, const GraphInput* inputs, size_t inputCount, ma_uint32 frameCount) {
+        const size_t samples = (size_t)frameCount * audioFormat.channels;
+        float* block = static_cast<float*>(current().sourceScratch.acquire(samples * sizeof(float)));
+        const std::vector<Source*>& mixed = getMixedSources();
+
+        memset(mix, 0, samples * sizeof(float));
+
+        for (size_t i = 0; i < mixed.size(); i++) {
+            Source& source = *mixed[i];
+            const float gain = source.gain.load(std::memory_order_relaxed);
+            if (const void* rendered = findGraphBlock(inputs, inputCount, i, source.node)) {
+                mixAccumulateF32(mix, static_cast<const float*>(rendered), gain, samples);
+                continue;
+            }
+
+            ma_uint32 read = source.port->receivePCM(block, frameCount);
+            takeMarker(source.port.get());
+            if (read > 0)
+                mixAccumulateF32(mix, block, gain, (size_t)read * audioFormat.channels);
+        }
+
+        applyClip(mix, frameCount);
+    }
+
+    // Every source ran out, tailFrames is the longest last block among them
+    bool haveSourcesEnded(ma_uint32& tailFrames) {
+        const std::vector<Source*>& mixed = getMixedSources();
+        tailFrames = 0;
+        for (Source* source : mixed) {
+            ma_uint32 sourceTail = 0;
+            if (!static_cast<AudioEndpoint*>(source->port.get())->checkEndOfStream(sourceTail)) return false;
+            tailFrames = std::max(tailFrames, sourceTail);
+        }
+        return !mixed.empty();
+    }
+
+protected:
+    void whenOutputSubmitted(void*, ma_uint32 frameCount) override {
+        ma_uint32 tailFrames = 0;
+        if (getMixedSources().empty() || haveSourcesEnded(tailFrames)) return;
+
+        frameCount = getRenderFrames(frameCount);
+        float* mix = static_cast<float*>(current().mixScratch.acquire(audioFormat.frameSizeInBytes(frameCount)));
+        mixSources(mix, nullptr, 0, frameCount);
+        pushToOutputRing(mix, frameCount);
+    }
+
+    // Snapshot of the sources for the standby pipeline
+    void preparePipeline(Pipeline& target) override {
+        auto list = std::make_unique<SourceList>();
+        for (auto& source : sources)
+            list->sources.push_back(source.get());
+        target.state = std::move(list);
+    }
+
+    bool isGraphRenderable() const override { return true; }
+
+    bool checkEndOfStream(ma_uint32& tailFrames) override {
+        PipelineScope scope(this);
+        return haveSourcesEnded(tailFrames) && !hasBufferedFrames(current());
+    }
+
+    void collectGraphInputs(std::vector<AudioNode*>& inputs) override {
+        for (auto& source : sources)
+            inputs.push_back(source->input);
+    }
+
+    void renderGraphBlock(const GraphInput* inputs, size_t inputCount, void* pOut, ma_uint32 frames) override {
+        mixSources(static_cast<float*>(pOut), inputs, inputCount, frames);
+    }
+
+public:
+    /// <summary>
+    /// Final stage applied to the mix. Default is the limiter, which leaves a mix under its ceiling untouched.
+    /// </summary>
+    AudioCombinerClipMode clipMode = AudioCombinerClipMode::Limiter;
+
+    /// <summary>
+    /// Limiter ceiling (linear, 1.0 = full scale) and release smoothing per block (0..1, higher is faster).
+    /// </summary>
+    float limiterCeiling = 0.98f;
+    float limiterRelease = 0.1f;
+
+    /// <summary>
+    /// Creates a combiner, mixing always happens in f32 with the given channels and sample rate.
+    /// </summary>
+    AudioCombiner(const AudioFormat& format = AudioFormat::Stereo48kF32())
+        : AudioStream(AudioFormat(ma_format_f32, format.channels, format.sampleRate), true, false) {}
+
+    virtual ~AudioCombiner() { removeAllInputs(); }
+
+    /// <summary>
+    /// Adds an input to the mix.
+    /// </summary>
+    /// <param name="input">Input to mix, it can still feed other outputs</param>
+    /// <param name="gain">Linear gain for this input</param>
+    /// <returns>Subscription result</returns>
+    ma_result addInput(AudioInput* input, float gain = 1.0f) {
+        if (input == nullptr) return MA_INVALID_ARGS;
+        if (findSource(input)) return MA_DEVICE_ALREADY_INITIALIZED;
+
+        auto source = std::make_unique<Source>();
+        source->input = input;
+        source->node = input;
+        source->gain = gain;
+        source->port = std::make_unique<AudioStreamOutput>(audioFormat);
+
+        ma_result result = input->subscribe(source->port.get());
+        if (result != MA_SUCCESS) return result;
+
+        sources.push_back(std::move(source));
+        renegotiate(); // publishes the new list
+        return MA_SUCCESS;
+    }
+
+    ma_result removeInput(AudioInput* input) {
+        auto it = std::find_if(sources.begin(), sources.end(),
+            [input](const std::unique_ptr<Source>& source) { return source->input == input; });
+        if (it == sources.end()) return MA_INVALID_ARGS;
+
+        std::unique_ptr<Source> removed = std::move(*it);
+        sources.erase(it);
+
+        ma_result result = removed->port->unsubscribe();
+        renegotiate(); // once published, no callback holds the list with the removed port
+        return result;
+    }
+
+    void removeAllInputs() {
+        while (!sources.empty())
+            removeInput(sources.back()->input);
+    }
+
+    ma_result setGain(AudioInput* input, float gain) {
+        Source* source = findSource(input);
+        if (!source) return MA_INVALID_ARGS;
+
+        source->gain.store(gain, std::memory_order_relaxed);
+        return MA_SUCCESS;
+    }
+
+    float getGain(AudioInput* input) {
+        Source* source = findSource(input);
+        return source ? source->gain.load(std::memory_order_relaxed) : 0.0f;
+    }
+
+    size_t getInputCount() const { return sources.size(); }
+};
@@ -1,10 +1,155 @@
 #pragma once
 
 #include "../include.h"
+#include "../core/AudioStream.h"
+#include "../input/AudioInput.h"
+#include "../output/AudioOutput.h"
 
-class AudioMixer : AudioNode {
-	
-	AudioFormat inputFormat;
-	AudioFormat outputFormat;
+// AudioMixer:
+// - Base class for block-based DSP nodes (effects, mixers), placed between an input and an output.
+// - process() works on planar f32 blocks of at most getBlockFrames() frames.
+// - inputFormat is what upstream is negotiated to, outputFormat what process() produces
+//   (same sample rate, channel count can differ). Both are f32.
+// - Planar buffers are preallocated; when both formats match, out aliases in (in place).
+// - Clocked by its output: each consumed block pulls and processes the next one.
 
-};
\ No newline at end of file
+class AudioMixer : public AudioStream, public virtual AudioInput, public virtual AudioOutput {
+private:
+    ma_uint32 blockFrames;
+
+    std::vector<float> inputPlanes;
+    std::vector<float> outputPlanes;
+    std::vector<const float*> inputPointers;
+    std::vector<float*> outputPointers;
+
+    void deinterleave(const float* interleaved, ma_uint32 frames) {
+        const ma_uint32 channels = inputFormat.channels;
+        for (ma_uint32 ch = 0; ch < channels; ch++) {
+            float* plane = inputPlanes.data() + (size_t)ch * blockFrames;
+            for (ma_uint32 i = 0; i < frames; i++)
+                plane[i] = interleaved[(size_t)i * channels + ch];
+        }
+    }
+
+    void interleave(float* interleaved, ma_uint32 frames) {
+        const ma_uint32 channels = outputFormat.channels;
+        for (ma_uint32 ch = 0; ch < channels; ch++) {
+            const float* plane = outputPointers[ch];
+            for (ma_uint32 i = 0; i < frames; i++)
+                interleaved[(size_t)i * channels + ch] = plane[i];
+        }
+    }
+
+protected:
+    AudioFormat inputFormat;
+    AudioFormat outputFormat;
+
+    /// <summary>
+    /// Processes one block of at most getBlockFrames() frames: a render that is not a multiple of it
+    /// ends with a shorter one. in has inputFormat.channels planes, out has outputFormat.channels planes.
+    /// When isInPlace(), out points to the same planes as in. Default copies in to out.
+    /// </summary>
+    virtual void process(const float* const* in, float* const* out, ma_uint32 frames) {
+        if (isInPlace()) return;
+
+        for (ma_uint32 ch = 0; ch < outputFormat.channels; ch++) {
+            const float* source = in[std::min(ch, inputFormat.channels - 1)];
+            memcpy(out[ch], source, frames * sizeof(float));
+        }
+    }
+
+    // Interleaved in (inputFormat) -> process() block by block -> interleaved out (outputFormat)
+    void renderBlocks(const float* interleavedIn, float* interleavedOut, ma_uint32 frameCount) {
+        for (ma_uint32 offset = 0; offset < frameCount; offset += blockFrames) {
+            const ma_uint32 frames = std::min(blockFrames, frameCount - offset);
+
+            deinterleave(interleavedIn + (size_t)offset * inputFormat.channels, frames);
+            process(inputPointers.data(), outputPointers.data(), frames);
+            interleave(interleavedOut + (size_t)offset * outputFormat.channels, frames);
+        }
+    }
+
+    // Upstream writes in our input format, what it could not deliver is silence
+    const float* pullInput(ma_uint32 frameCount, ma_uint32* framesPulled = nullptr) {
+        float* interleavedIn = static_cast<float*>(current().mixScratch.acquire(inputFormat.frameSizeInBytes(frameCount)));
+        ma_uint32 pulled = isInputSubscribed() ? pullFromEndpoint(interleavedIn, frameCount) : 0;
+        if (framesPulled) *framesPulled = pulled;
+        if (pulled < frameCount)
+            memset(interleavedIn + (size_t)pulled * inputFormat.channels, 0, inputFormat.frameSizeInBytes(frameCount - pulled));
+        return interleavedIn;
+    }
+
+    void whenOutputSubmitted(void*, ma_uint32 frameCount) override {
+        if (!isInputSubscribed()) return;
+
+        // upstream ran out: let the output FIFO drain rather than padding it with silence forever
+        ma_uint32 tailFrames = 0;
+        if (isInputEndOfStream(tailFrames)) return;
+
+        frameCount = getRenderFrames(frameCount);
+        ma_uint32 pulled = 0;
+        const float* interleavedIn = pullInput(frameCount, &pulled);
+
+        // the last frames upstream had, nothing after them
+        if (pulled < frameCount && isInputEndOfStream(tailFrames)) frameCount = pulled;
+        if (frameCount == 0) return;
+        float* interleavedOut = static_cast<float*>(current().sourceScratch.acquire(outputFormat.frameSizeInBytes(frameCount)));
+
+        renderBlocks(interleavedIn, interleavedOut, frameCount);
+        pushToOutputRing(interleavedOut, frameCount);
+    }
+
+    bool isGraphRenderable() const override { return true; }
+    bool canRenderInPlace() const override { return isInPlace(); }
+
+    void renderGraphBlock(const GraphInput* inputs, size_t inputCount, void* pOut, ma_uint32 frames) override {
+        const float* interleavedIn = inputCount > 0 && inputs[0].block ? static_cast<const float*>(inputs[0].block) : pullInput(frames);
+        renderBlocks(interleavedIn, static_cast<float*>(pOut), frames);
+    }
+
+public:
+    AudioMixer(const AudioFormat& inputFormat, const AudioFormat& outputFormat, ma_uint32 blockFrames = 256)
+        : AudioStream(AudioFormat(ma_format_f32, inputFormat.channels, inputFormat.sampleRate), true, false),
+          blockFrames(std::max<ma_uint32>(blockFrames, 1))
+    {
+        this->inputFormat = audioFormat;
+        this->outputFormat = AudioFormat(ma_format_f32, outputFormat.channels, inputFormat.sampleRate);
+
+        hasProducedFormat = true;
+        producedFormat = this->outputFormat;
+
+        inputPlanes.resize((size_t)this->inputFormat.channels * this->blockFrames);
+        for (ma_uint32 ch = 0; ch < this->inputFormat.channels; ch++)
+            inputPointers.push_back(inputPlanes.data() + (size_t)ch * this->blockFrames);
+
+        if (isInPlace()) {
+            for (ma_uint32 ch = 0; ch < this->outputFormat.channels; ch++)
+                outputPointers.push_back(inputPlanes.data() + (size_t)ch * this->blockFrames);
+        } else {
+            outputPlanes.resize((size_t)this->outputFormat.channels * this->blockFrames);
+            for (ma_uint32 ch = 0; ch < this->outputFormat.channels; ch++)
+                outputPointers.push_back(outputPlanes.data() + (size_t)ch * this->blockFrames);
+        }
+    }
+
+    AudioMixer(const AudioFormat& format, ma_uint32 blockFrames = 256) : AudioMixer(format, format, blockFrames) {}
+
+    virtual ~AudioMixer() = default;
+
+    bool isSubscribed() override { return areBothSubscribed(); }
+
+    using AudioInput::subscribe;
+    using AudioOutput::subscribe;
+
+    ma_result unsubscribe(AudioOutput* destination) { return AudioInput::unsubscribe(destination); }
+    ma_result unsubscribe() {
+        unsubscribeAll();
+        return MA_SUCCESS;
+    }
+
+    bool isInPlace() const { return inputFormat.channels == outputFormat.channels; }
+    ma_uint32 getBlockFrames() const { return blockFrames; }
+    // What process() is handed and what it produces, not the linked nodes' formats (AudioEndpoint's getters)
+    const AudioFormat& getBlockInputFormat() const { return inputFormat; }
+    const AudioFormat& getBlockOutputFormat() const { return outputFormat; }
+};
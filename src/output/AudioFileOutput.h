@@ -1,42 +1,305 @@
 #pragma once
 
 #include "../core/AudioFile.h"
+#include "../core/AudioStats.h"
 #include "../output/AudioOutput.h"
 
+// What a file output does when its writer thread falls behind and the queue is full.
+// - DropNewest: the pushing thread never waits, frames that do not fit are dropped and counted.
+// - WriteThrough: the pushing thread flushes the queue and writes the rest itself, nothing is
+//   lost but disk latency reaches that thread.
+enum class AudioWriteOverflowPolicy {
+    DropNewest,
+    WriteThrough
+};
+
+// AudioFileOutput:
+// - Encodes what it receives into a file.
+// - Async writing (default): the pushing thread (often a device callback) only copies frames into
+//   a lock-free queue, a writer thread encodes them in large batches. Batches are a power of two
+//   frames and a multiple of 4 KiB, they never straddle the queue's wrap.
+// - Offline renders (consumeRenderedBlock) write straight to the encoder, nothing is dropped.
+// - Targets other than a path: a path inside a ma_vfs, or an AudioFileStream (AudioMemoryStream
+//   encodes the whole file into memory).
+
 class AudioFileOutput : public AudioFile, public virtual AudioOutput {
+private:
+    static constexpr ma_uint32 writeAlignmentBytes = 4096;
+
+    std::unique_ptr<AudioFrameRing> writeQueue; // over-aligned, kept on the heap
+    std::mutex encoderMutex;                    // whoever drains the queue and writes holds it
+    std::thread writerThread;
+    std::atomic<bool> isWritingAsync{ false };
+    std::atomic<bool> stopWriting{ false };
+    ma_uint32 batchFrames = 0;
+
+    std::atomic<ma_uint64> writtenFrames{ 0 };
+    std::atomic<ma_uint64> writes{ 0 };
+    std::atomic<ma_uint64> writeTimeNs{ 0 };
+    std::atomic<ma_uint64> maxWriteNs{ 0 };
+    std::atomic<ma_uint64> overflows{ 0 };
+    std::atomic<ma_uint64> droppedFrames{ 0 };
+    std::atomic<ma_uint64> writeThroughFrames{ 0 };
+
+    static ma_uint32 nextPowerOfTwo(ma_uint32 value) {
+        ma_uint32 result = 1;
+        while (result < value) result <<= 1;
+        return result;
+    }
+
+    // Timed encoder write, callers hold encoderMutex once the writer runs
+    ma_result encode(const void* pData, ma_uint32 frames) {
+        const auto start = std::chrono::steady_clock::now();
+        const ma_result result = writeToFile(pData, frames);
+        const ma_uint64 elapsed = (ma_uint64)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+
+        writes.fetch_add(1, std::memory_order_relaxed);
+        writeTimeNs.fetch_add(elapsed, std::memory_order_relaxed);
+        ma_uint64 current = maxWriteNs.load(std::memory_order_relaxed);
+        while (elapsed > current && !maxWriteNs.compare_exchange_weak(current, elapsed, std::memory_order_relaxed)) {}
+
+        if (result == MA_SUCCESS) writtenFrames.fetch_add(frames, std::memory_order_relaxed);
+        return result;
+    }
+
+    // Queue consumer, under encoderMutex
+    void drainQueue(ma_uint32 maxFrames) {
+        while (maxFrames > 0) {
+            AudioRingSpans spans;
+            const ma_uint32 frames = writeQueue->acquireRead(maxFrames, &spans);
+            if (frames == 0) break;
+
+            encode(spans.first, spans.firstFrames);
+            if (spans.secondFrames > 0) encode(spans.second, spans.secondFrames);
+            writeQueue->commitRead(frames);
+            maxFrames -= frames;
+        }
+    }
+
+    void writerLoop(std::chrono::microseconds pollInterval) {
+        while (!stopWriting.load(std::memory_order_relaxed)) {
+            if (writeQueue->availableRead() < batchFrames) {
+                std::this_thread::sleep_for(pollInterval);
+                continue;
+            }
+
+            std::lock_guard<std::mutex> lock(encoderMutex);
+            drainQueue(batchFrames);
+        }
+
+        // flush, the pushing side stopped queueing before stopWriting was set
+        std::lock_guard<std::mutex> lock(encoderMutex);
+        drainQueue(UINT32_MAX);
+    }
+
+    void startWriter(const AudioFormat& format) {
+        const ma_uint32 frameSize = format.frameSizeInBytes();
+        if (!asyncWrite || frameSize == 0 || format.sampleRate == 0) return;
+
+        // smallest power of two frame count that is a multiple of 4 KiB, grown to writeBatchMS
+        ma_uint32 alignFrames = 1;
+        while ((alignFrames * frameSize) % writeAlignmentBytes != 0) alignFrames <<= 1;
+        batchFrames = std::max(alignFrames, nextPowerOfTwo(std::max<ma_uint32>(format.sampleRate * writeBatchMS / 1000, 1)));
+
+        const ma_uint32 queueFrames = std::max(batchFrames * 2, format.sampleRate * writeQueueMS / 1000);
+        if (!writeQueue) writeQueue = std::make_unique<AudioFrameRing>();
+        if (writeQueue->init(frameSize, queueFrames) != MA_SUCCESS) return;
+
+        // polls four times per batch, 1-50ms
+        const ma_uint64 batchUs = (ma_uint64)batchFrames * 1000000 / format.sampleRate;
+        const std::chrono::microseconds pollInterval(std::clamp<ma_uint64>(batchUs / 4, 1000, 50000));
+
+        stopWriting = false;
+        writerThread = std::thread(&AudioFileOutput::writerLoop, this, pollInterval);
+        isWritingAsync = true;
+    }
+
+    void stopWriter() {
+        isWritingAsync = false;
+        stopWriting = true;
+        if (!writerThread.joinable()) return;
+        writerThread.join();
+
+        // a push that was already queueing when the flag dropped
+        std::lock_guard<std::mutex> lock(encoderMutex);
+        drainQueue(UINT32_MAX);
+    }
+
+    // Producer side: queue everything the input ring holds
+    void queueInput(Pipeline& p) {
+        ma_uint32 available = p.inputRing.availableRead();
+        while (available > 0) {
+            AudioRingSpans spans;
+            const ma_uint32 frames = p.inputRing.acquireRead(available, &spans);
+            if (frames == 0) break;
+
+            queueFrames(spans.first, spans.firstFrames);
+            if (spans.secondFrames > 0) queueFrames(spans.second, spans.secondFrames);
+            p.inputRing.commitRead(frames);
+            available -= frames;
+        }
+    }
+
+    void queueFrames(const void* pData, ma_uint32 frames) {
+        const ma_uint32 queued = writeQueue->write(pData, frames);
+        if (queued == frames) return;
+
+        const ma_uint32 rest = frames - queued;
+        overflows.fetch_add(1, std::memory_order_relaxed);
+
+        if (overflowPolicy == AudioWriteOverflowPolicy::DropNewest) {
+            droppedFrames.fetch_add(rest, std::memory_order_relaxed);
+            return;
+        }
+
+        // older frames go first
+        std::lock_guard<std::mutex> lock(encoderMutex);
+        drainQueue(UINT32_MAX);
+        if (encode((const ma_uint8*)pData + writeQueue->getFrameSize() * (size_t)queued, rest) == MA_SUCCESS)
+            writeThroughFrames.fetch_add(rest, std::memory_order_relaxed);
+    }
+
+    ma_result openTarget(const AudioFormat& targetFormat, ma_encoding_format targetEncodingFormat) {
+        ma_result result = openEncoder(targetFormat, targetEncodingFormat);
+        if (result == MA_SUCCESS) startWriter(targetFormat);
+        else clearSource();
+        return result;
+    }
+
 protected:
     void whenInputSubmitted(const void*, ma_uint32) override {
         if (!hasEncoder) return;
 
-        ma_pcm_rb ring = AudioFile::inputRing;
-        const ma_uint32 available = ma_pcm_rb_available_read(&ring);
+        Pipeline& p = AudioEndpoint::current();
+        if (isWritingAsync) {
+            queueInput(p);
+            return;
+        }
+
+        const ma_uint32 available = p.inputRing.availableRead();
 
         if (available > 0) {
-            std::vector<uint8_t> buffer(AudioEndpoint::inputRingFormat.frameSizeInBytes(available));
+            void* buffer = p.mixScratch.acquire(
+                p.inputRingFormat.frameSizeInBytes(available));
 
             ma_uint32 framesRead = AudioEndpoint::readRing(
-                AudioEndpoint::inputRing,
-                AudioEndpoint::inputRingFormat,
-                buffer.data(),
+                p.inputRing,
+                p.inputRingFormat,
+                buffer,
                 available
             );
 
-            if (framesRead > 0)
-                bufferStatus = writeToFile(buffer.data(), framesRead);
+            if (framesRead > 0) {
+                std::lock_guard<std::mutex> lock(encoderMutex); // uncontended without the writer
+                bufferStatus = encode(buffer, framesRead);
+            }
         }
     }
 
+    // Offline rendering hands blocks already in the file's format, straight to the encoder
+    ma_result consumeRenderedBlock(const void* pData, ma_uint32 frames) override {
+        std::lock_guard<std::mutex> lock(encoderMutex);
+        return encode(pData, frames);
+    }
+
 public:
+    /// <summary>
+    /// Encodes on a writer thread, the pushing thread only queues frames. Applied by open().
+    /// </summary>
+    bool asyncWrite = true;
+
+    /// <summary>
+    /// Writer queue length in ms, how long the disk may stall before overflowPolicy applies. Default is 2000.
+    /// </summary>
+    ma_uint32 writeQueueMS = 2000;
+
+    /// <summary>
+    /// Audio written per encoder call in ms, rounded up to a power of two frames. Default is 100.
+    /// </summary>
+    ma_uint32 writeBatchMS = 100;
+
+    /// <summary>
+    /// What happens when the writer queue is full. Default is DropNewest, capture never waits.
+    /// </summary>
+    AudioWriteOverflowPolicy overflowPolicy = AudioWriteOverflowPolicy::DropNewest;
+
     AudioFileOutput() : AudioFile(true, true) {}
+    ~AudioFileOutput() { stopWriter(); }
 
+    /// <summary>
+    /// Writes a file on disk, or a path inside vfs when given. The encoding follows the extension
+    /// unless targetEncodingFormat is set.
+    /// </summary>
     ma_result open(
-        const std::string& path, 
-        const AudioFormat& targetFormat, 
-        ma_encoding_format targetEncodingFormat = ma_encoding_format_unknown
+        const std::string& path,
+        const AudioFormat& targetFormat,
+        ma_encoding_format targetEncodingFormat = ma_encoding_format_unknown,
+        ma_vfs* vfs = nullptr
     ) {
-        return openFileEncode(path, targetFormat, targetEncodingFormat);
+        close();
+        setSource(path, vfs);
+        return openTarget(targetFormat, guessEncodingFormat(path, targetEncodingFormat));
+    }
+
+    /// <summary>
+    /// Encodes into stream, which must support write and seek. Written from the writer thread
+    /// (or the pushing thread when asyncWrite is off), complete once close() returns.
+    /// </summary>
+    ma_result openStream(
+        std::shared_ptr<AudioFileStream> stream,
+        const AudioFormat& targetFormat,
+        ma_encoding_format targetEncodingFormat = ma_encoding_format_wav
+    ) {
+        close();
+        if (stream == nullptr) return MA_INVALID_ARGS;
+
+        setSource(std::move(stream), "");
+        return openTarget(targetFormat, targetEncodingFormat);
+    }
+
+    /// <summary>
+    /// Writes what is still queued, then closes the file.
+    /// </summary>
+    void close() {
+        stopWriter();
+        closeEncoder();
+        clearSource();
     }
 
-    void close() { closeEncoder(); }
     bool isOpen() const { return isEncoderOpen(); }
-};
\ No newline at end of file
+
+    /// <summary>
+    /// Writer timings, queue fill and overflows. Safe from any thread.
+    /// </summary>
+    AudioWriteStats getWriteStats() const {
+        AudioWriteStats out;
+        out.isWritingAsync = isWritingAsync;
+        out.writtenFrames = writtenFrames.load(std::memory_order_relaxed);
+        out.writes = writes.load(std::memory_order_relaxed);
+        out.writeTimeMS = writeTimeNs.load(std::memory_order_relaxed) / 1e6;
+        out.maxWriteMS = maxWriteNs.load(std::memory_order_relaxed) / 1e6;
+        out.overflows = overflows.load(std::memory_order_relaxed);
+        out.droppedFrames = droppedFrames.load(std::memory_order_relaxed);
+        out.writeThroughFrames = writeThroughFrames.load(std::memory_order_relaxed);
+        if (out.isWritingAsync && writeQueue) {
+            out.queuedFrames = writeQueue->availableRead();
+            out.queueCapacity = writeQueue->getCapacity();
+            out.batchFrames = batchFrames;
+        }
+        return out;
+    }
+
+    /// <summary>
+    /// Clears the writer counters.
+    /// </summary>
+    void resetWriteStats() {
+        writtenFrames = 0;
+        writes = 0;
+        writeTimeNs = 0;
+        maxWriteNs = 0;
+        overflows = 0;
+        droppedFrames = 0;
+        writeThroughFrames = 0;
+    }
+};
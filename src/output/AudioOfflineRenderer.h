@@ -0,0 +1,156 @@
+#pragma once
+
+#include "../include.h"
+#include "../core/AudioEndpoint.h"
+#include "../core/AudioGraph.h"
+#include "./AudioOutput.h"
+
+// AudioOfflineRenderer:
+// - Drives a sink (a file output) from the calling thread as fast as the CPU allows,
+//   no device, no miniaudio context and no SoundIO::initialize() needed.
+// - Each block is rendered the way a speaker renders a device period: one scheduled pass
+//   of the sink's AudioGraph when the nodes upstream can render in blocks, a pull through
+//   the rings otherwise. The block is handed to the sink in its own format.
+// - Stops at the end of stream: once every file input upstream ran out and the frames it
+//   decoded went through. On the scheduled path the last block is trimmed to the frames
+//   that were real, the output is as long as the longest input.
+// - Live sources (stream inputs) never end, bound those renders with maxFrames.
+// - Sources decoding on a background thread (decode-ahead file inputs) are waited for,
+//   the render is the same as with them decoding on the calling thread.
+
+class AudioOfflineRenderer {
+private:
+    // Ring pulls coming back empty this many blocks in a row mean nothing upstream produces
+    static constexpr ma_uint32 stallBlocks = 64;
+
+    AudioEndpoint* sink = nullptr;
+    AudioGraph graph;
+    ma_uint32 graphBlockFrames = 0;
+
+    std::vector<ma_uint8> block;
+    ma_uint64 renderedFrames = 0;
+    ma_uint32 emptyPulls = 0;
+    bool hasEnded = false;
+    double renderSeconds = 0.0;
+
+    void prepare() {
+        const ma_uint32 frames = std::max<ma_uint32>(blockFrames, 1);
+        block.resize((size_t)sink->audioFormat.frameSizeInBytes(frames));
+
+        if (graphBlockFrames != frames) {
+            graphBlockFrames = frames;
+            graph.blockFrames = frames;
+            graph.rebuild();
+        }
+    }
+
+    ma_result renderFrames(ma_uint32 frames, ma_uint32* framesRendered) {
+        if (framesRendered) *framesRendered = 0;
+        if (hasEnded) return MA_AT_END;
+        if (sink->inputNode == nullptr || !sink->isNegociationDone) return MA_NOT_CONNECTED;
+
+        const auto start = std::chrono::steady_clock::now();
+        AudioEndpoint::isRenderingOffline = true;
+        const ma_result result = renderPass(frames, framesRendered);
+        AudioEndpoint::isRenderingOffline = false;
+        renderSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return result;
+    }
+
+    ma_result renderPass(ma_uint32 frames, ma_uint32* framesRendered) {
+        prepare();
+        frames = std::min(frames, graphBlockFrames);
+        ma_uint32 tailFrames = 0;
+        ma_uint32 written = 0;
+
+        AudioEndpoint::PipelineScope scope(sink);
+        if (graph.render(block.data(), frames)) {
+            // scheduled nodes render 1:1, the sources say how much of the block was real
+            hasEnded = sink->isInputEndOfStream(tailFrames);
+            written = hasEnded ? std::min(tailFrames, frames) : frames;
+        } else {
+            // checked before pulling: what is still in the rings is pulled first
+            if (sink->isInputEndOfStream(tailFrames)) {
+                hasEnded = true;
+                return MA_AT_END;
+            }
+
+            written = sink->pullFromEndpoint(block.data(), frames);
+            emptyPulls = written > 0 ? 0 : emptyPulls + 1;
+            if (emptyPulls >= stallBlocks) return MA_NO_DATA_AVAILABLE;
+        }
+
+        if (written > 0) {
+            ma_result result = sink->consumeRenderedBlock(block.data(), written);
+            if (result != MA_SUCCESS) return result;
+        }
+
+        renderedFrames += written;
+        if (framesRendered) *framesRendered = written;
+        return hasEnded ? MA_AT_END : MA_SUCCESS;
+    }
+
+public:
+    /// <summary>
+    /// Frames rendered per block, at the sink's sample rate. Default is 1024.
+    /// </summary>
+    ma_uint32 blockFrames = 1024;
+
+    explicit AudioOfflineRenderer(AudioOutput* sink) : sink(sink), graph(sink) {}
+
+    AudioOfflineRenderer(const AudioOfflineRenderer&) = delete;
+    AudioOfflineRenderer& operator=(const AudioOfflineRenderer&) = delete;
+
+    /// <summary>
+    /// Renders one block into the sink.
+    /// </summary>
+    /// <param name="framesRendered">Frames the sink received, can be less than blockFrames at the end</param>
+    /// <returns>MA_AT_END once the stream ended, MA_NOT_CONNECTED without an input, or the sink's error</returns>
+    ma_result renderBlock(ma_uint32* framesRendered = nullptr) {
+        return renderFrames(blockFrames, framesRendered);
+    }
+
+    /// <summary>
+    /// Renders until the end of stream, or until maxFrames more frames were rendered.
+    /// </summary>
+    /// <returns>MA_SUCCESS when the stream ended or maxFrames was reached, otherwise the first error</returns>
+    ma_result render(ma_uint64 maxFrames = UINT64_MAX) {
+        const ma_uint64 target = maxFrames == UINT64_MAX ? UINT64_MAX : renderedFrames + maxFrames;
+
+        ma_result result = MA_SUCCESS;
+        while (renderedFrames < target) {
+            // the last block stops at maxFrames
+            result = renderFrames((ma_uint32)std::min<ma_uint64>(blockFrames, target - renderedFrames), nullptr);
+            if (result != MA_SUCCESS) break;
+        }
+
+        return result == MA_AT_END ? MA_SUCCESS : result;
+    }
+
+    bool isFinished() const { return hasEnded; }
+    ma_uint64 getRenderedFrames() const { return renderedFrames; }
+
+    /// <summary>
+    /// Seconds of audio rendered per second spent rendering, 0 before the first block.
+    /// </summary>
+    double getRealtimeFactor() const {
+        const ma_uint32 sampleRate = sink->audioFormat.sampleRate;
+        if (renderSeconds <= 0.0 || sampleRate == 0) return 0.0;
+        return (double)renderedFrames / sampleRate / renderSeconds;
+    }
+
+    /// <summary>
+    /// Starts over after the inputs were reopened or rewound.
+    /// </summary>
+    void reset() {
+        renderedFrames = 0;
+        emptyPulls = 0;
+        hasEnded = false;
+        renderSeconds = 0.0;
+    }
+
+    /// <summary>
+    /// Nodes rendered in one scheduled pass, 0 when blocks are pulled through the rings.
+    /// </summary>
+    size_t getScheduledNodeCount() { return graph.getScheduledNodeCount(); }
+};
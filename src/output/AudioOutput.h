@@ -12,12 +12,12 @@ public:
     ma_result unsubscribe() { return unsubscribeInput(); }
 
     ma_uint32 getAvailableReadFrames() {
-        return getRingAvailableRead(&inputRing);
+        PipelineScope scope(this);
+        return getRingAvailableRead(&current().inputRing);
     }
 
     virtual ~AudioOutput() = default;
 };
 
-inline ma_result AudioOutput::subscribe(AudioInput* source) {
-    return subscribeInput(reinterpret_cast<AudioNode*>(source));
-}
+// AudioOutput::subscribe is defined with AudioInput
+#include "../input/AudioInput.h"
@@ -43,9 +43,11 @@ static bool normalizeDeviceId(ma_backend backend,
     std::string deviceIdStr;
 
     switch (backend) {
+#if defined(_WIN32)
         case ma_backend_wasapi: {
             deviceIdStr = convertWideCharToString(deviceId.wasapi, MAX_DEVICE_ID_BUFFER);
         } break;
+#endif
 
         case ma_backend_dsound: {
             std::ostringstream guidStream;
@@ -2,79 +2,94 @@
 #include "../include.h"
 #include "./deviceid.h"
 
-static void loopDevices(
-    ma_context& context, ma_device_info* devices, ma_uint32 deviceCount, ma_device_type deviceType,
-    const std::function<void(ma_device_info, std::string, ma_format, ma_uint32, ma_uint32)>& callback
-) {
-    for (ma_uint32 i = 0; i < deviceCount; i++) {
-        auto& deviceInfo = devices[i];
-
-        // get detailed device info
-        ma_device_info detailedInfo;
-        if (ma_context_get_device_info(&context, deviceType, &deviceInfo.id, &detailedInfo) != MA_SUCCESS)
+// Picks the format a device is opened with from its native formats (ma_context_get_device_info),
+// false when none is usable
+static bool pickDeviceFormat(const ma_device_info& detailedInfo, ma_format& format, ma_uint32& sampleRate, ma_uint32& channels) {
+    // devices with no available formats can't be opened
+    ma_uint32 formatCount = detailedInfo.nativeDataFormatCount;
+    if (formatCount == 0) return false;
+
+    // the best format will be picked
+    ma_format bestFormat = ma_format_unknown;
+    ma_uint32 bestSampleRate = 44100;
+    ma_uint32 bestChannels = 2;
+    bool bestIsExclusive = false;
+
+    for (ma_uint32 j = 0; j < formatCount; j++) {
+        auto& deviceFormat = detailedInfo.nativeDataFormats[j];
+
+        // check if this format supports Exclusive Mode
+        bool isExclusive = (deviceFormat.flags & MA_DATA_FORMAT_FLAG_EXCLUSIVE_MODE) != 0;
+
+        // skip formats that are completely unusable
+        if (deviceFormat.format == ma_format_unknown || deviceFormat.sampleRate == 0)
             continue;
 
-        // devices with no available formats are skipped
-        ma_uint32 formatCount = detailedInfo.nativeDataFormatCount;
-        if (formatCount == 0) continue;
+        // Prioritize:
+        // Float32 > 16-bit
+        // Higher sample rate
+        // Exclusive mode preferred
+        bool isBetter = false;
 
-        // the best format will be picked
-        ma_format bestFormat = ma_format_unknown;
-        ma_uint32 bestSampleRate = 44100;
-        ma_uint32 bestChannels = 2;
-        bool bestIsExclusive = false;
+        // First valid format -> Always accept
+        if (bestFormat == ma_format_unknown)
+            isBetter = true;
 
-        for (ma_uint32 j = 0; j < formatCount; j++) {
-            auto& deviceFormat = detailedInfo.nativeDataFormats[j];
+        // Prefer Float32 over anything else
+        else if (deviceFormat.format == ma_format_f32 && bestFormat != ma_format_f32)
+            isBetter = true;
 
-            // check if this format supports Exclusive Mode
-            bool isExclusive = (deviceFormat.flags & MA_DATA_FORMAT_FLAG_EXCLUSIVE_MODE) != 0;
+        // Prefer higher sample rates
+        else if (deviceFormat.format == bestFormat && deviceFormat.sampleRate > bestSampleRate)
+            isBetter = true;
 
-            // skip formats that are completely unusable
-            if (deviceFormat.format == ma_format_unknown || deviceFormat.sampleRate == 0)
-                continue;
+        // Prefer more channels if everything else is equal
+        else if (deviceFormat.format == bestFormat && deviceFormat.sampleRate == bestSampleRate &&
+            deviceFormat.channels > bestChannels)
+            isBetter = true;
 
-            // Prioritize:
-            // Float32 > 16-bit
-            // Higher sample rate
-            // Exclusive mode preferred
-            bool isBetter = false;
+        // Prefer Exclusive Mode if format/sample rate/channels are equal
+        else if (deviceFormat.format == bestFormat && deviceFormat.sampleRate == bestSampleRate &&
+            deviceFormat.channels == bestChannels && isExclusive && !bestIsExclusive)
+            isBetter = true;
 
-            // First valid format -> Always accept
-            if (bestFormat == ma_format_unknown)
-                isBetter = true;
+        if (!isBetter) continue;
 
-            // Prefer Float32 over anything else
-            else if (deviceFormat.format == ma_format_f32 && bestFormat != ma_format_f32)
-                isBetter = true;
+        bestFormat = deviceFormat.format;
+        bestSampleRate = deviceFormat.sampleRate;
+        bestChannels = deviceFormat.channels;
+        bestIsExclusive = isExclusive;
+    }
 
-            // Prefer higher sample rates
-            else if (deviceFormat.format == bestFormat && deviceFormat.sampleRate > bestSampleRate)
-                isBetter = true;
+    if (bestFormat == ma_format_unknown) return false;
 
-            // Prefer more channels if everything else is equal
-            else if (deviceFormat.format == bestFormat && deviceFormat.sampleRate == bestSampleRate &&
-                deviceFormat.channels > bestChannels)
-                isBetter = true;
+    format = bestFormat;
+    sampleRate = bestSampleRate;
+    channels = bestChannels;
+    return true;
+}
 
-            // Prefer Exclusive Mode if format/sample rate/channels are equal
-            else if (deviceFormat.format == bestFormat && deviceFormat.sampleRate == bestSampleRate &&
-                deviceFormat.channels == bestChannels && isExclusive && !bestIsExclusive)
-                isBetter = true;
+// Lists devices without querying them: probing formats opens each device on most backends and is
+// left to the devices themselves (AudioDevice::probe). Normalized ids are remembered per raw id.
+static void loopDevices(
+    ma_context& context, ma_device_info* devices, ma_uint32 deviceCount, ma_device_type deviceType,
+    std::unordered_map<std::string, std::string>& normalizedIds,
+    const std::function<void(const ma_device_info&, const std::string&)>& callback
+) {
+    for (ma_uint32 i = 0; i < deviceCount; i++) {
+        auto& deviceInfo = devices[i];
 
-            if (!isBetter) continue;
+        std::string rawId((const char*)&deviceInfo.id, sizeof(ma_device_id));
+        rawId.push_back((char)deviceType);
 
-            bestFormat = deviceFormat.format;
-            bestSampleRate = deviceFormat.sampleRate;
-            bestChannels = deviceFormat.channels;
-            bestIsExclusive = isExclusive;
+        auto found = normalizedIds.find(rawId);
+        if (found == normalizedIds.end()) {
+            // Probable error or something I do not wanna deal with, skip
+            std::string id;
+            if (!normalizeDeviceId(context.backend, deviceInfo.id, deviceType, &id)) continue;
+            found = normalizedIds.emplace(std::move(rawId), std::move(id)).first;
         }
 
-        // Probable error or something I do not wanna deal with, skip
-        std::string id;
-        if (bestFormat == ma_format_unknown || 
-            !normalizeDeviceId(context.backend, detailedInfo.id, deviceType, &id)) continue;
-
-        callback(detailedInfo, id, bestFormat, bestSampleRate, bestChannels);
+        callback(deviceInfo, found->second);
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,165 @@
+#pragma once
+#include "../include.h"
+
+// AudioFFT:
+// - Real-input FFT plan for a power of two size, built once and shared (getPlan()).
+// - Runs an N/2 complex radix-2 FFT on split real/imaginary arrays, then unpacks
+//   the N/2 + 1 real spectrum bins.
+// - Twiddles are stored per stage so every butterfly loop walks contiguous memory
+//   and the compiler can vectorize it.
+// - A plan is read-only once built, callers bring their own work buffers (makeWork()).
+
+class AudioFFT {
+private:
+    ma_uint32 size = 0;
+    ma_uint32 half = 0;
+
+    std::vector<ma_uint32> bitReverse;
+    std::vector<float> stageCos;  // cos(2pi j / len), stage after stage
+    std::vector<float> stageSin;  // -sin(2pi j / len)
+    std::vector<float> unpackCos; // cos(2pi k / size)
+    std::vector<float> unpackSin; // -sin(2pi k / size)
+    std::vector<float> window;    // periodic Hann
+    float windowSum = 0.0f;
+
+    static bool isPowerOfTwo(ma_uint32 value) { return value >= 4 && (value & (value - 1)) == 0; }
+
+    void butterflies(float* re, float* im) const {
+        size_t offset = 0;
+        for (ma_uint32 len = 2; len <= half; len <<= 1) {
+            const ma_uint32 span = len >> 1;
+            const float* wr = stageCos.data() + offset;
+            const float* wi = stageSin.data() + offset;
+
+            for (ma_uint32 start = 0; start < half; start += len) {
+                float* ar = re + start;
+                float* ai = im + start;
+                float* br = ar + span;
+                float* bi = ai + span;
+
+                for (ma_uint32 j = 0; j < span; j++) {
+                    const float tr = br[j] * wr[j] - bi[j] * wi[j];
+                    const float ti = br[j] * wi[j] + bi[j] * wr[j];
+                    br[j] = ar[j] - tr;
+                    bi[j] = ai[j] - ti;
+                    ar[j] += tr;
+                    ai[j] += ti;
+                }
+            }
+            offset += span;
+        }
+    }
+
+public:
+    // Per-caller buffers, sized for one plan
+    struct Work {
+        std::vector<float> re;
+        std::vector<float> im;
+    };
+
+    explicit AudioFFT(ma_uint32 fftSize) {
+        if (!isPowerOfTwo(fftSize)) return;
+
+        size = fftSize;
+        half = fftSize / 2;
+        const double pi = 3.14159265358979323846;
+
+        ma_uint32 bits = 0;
+        while ((1u << bits) < half) bits++;
+        bitReverse.resize(half);
+        for (ma_uint32 i = 0; i < half; i++) {
+            ma_uint32 reversed = 0;
+            for (ma_uint32 b = 0; b < bits; b++)
+                reversed |= ((i >> b) & 1u) << (bits - 1 - b);
+            bitReverse[i] = reversed;
+        }
+
+        for (ma_uint32 len = 2; len <= half; len <<= 1) {
+            for (ma_uint32 j = 0; j < len / 2; j++) {
+                stageCos.push_back((float)std::cos(2.0 * pi * j / len));
+                stageSin.push_back((float)-std::sin(2.0 * pi * j / len));
+            }
+        }
+
+        unpackCos.resize(half + 1);
+        unpackSin.resize(half + 1);
+        for (ma_uint32 k = 0; k <= half; k++) {
+            unpackCos[k] = (float)std::cos(2.0 * pi * k / size);
+            unpackSin[k] = (float)-std::sin(2.0 * pi * k / size);
+        }
+
+        window.resize(size);
+        for (ma_uint32 n = 0; n < size; n++) {
+            window[n] = (float)(0.5 - 0.5 * std::cos(2.0 * pi * n / size));
+            windowSum += window[n];
+        }
+    }
+
+    bool isValid() const { return size != 0; }
+    ma_uint32 getSize() const { return size; }
+    ma_uint32 getBinCount() const { return half + 1; }
+    const float* getWindow() const { return window.data(); }
+    float getWindowSum() const { return windowSum; }
+
+    Work makeWork() const {
+        Work work;
+        work.re.resize(half + 1);
+        work.im.resize(half + 1);
+        return work;
+    }
+
+    /// <summary>
+    /// Forward transform of size real samples.
+    /// work.re / work.im receive bins 0..size/2 (unnormalized).
+    /// </summary>
+    void forward(const float* input, Work& work) const {
+        float* re = work.re.data();
+        float* im = work.im.data();
+
+        // pack even samples as real, odd samples as imaginary, in bit reversed order
+        for (ma_uint32 i = 0; i < half; i++) {
+            const ma_uint32 j = bitReverse[i];
+            re[j] = input[2 * i];
+            im[j] = input[2 * i + 1];
+        }
+
+        butterflies(re, im);
+
+        // split the packed spectrum into the real one, X[k] = E[k] + W^k O[k]
+        const float dcRe = re[0], dcIm = im[0];
+        for (ma_uint32 k = 1, m = half - 1; k <= m; k++, m--) {
+            const float ar = re[k], ai = im[k], cr = re[m], ci = im[m];
+
+            const float er = 0.5f * (ar + cr), ei = 0.5f * (ai - ci);
+            const float orr = 0.5f * (ai + ci), oi = -0.5f * (ar - cr);
+            const float er2 = er, ei2 = -ei;   // E[m] = conj(E[k])
+            const float or2 = orr, oi2 = -oi;  // O[m] = conj(O[k])
+
+            re[k] = er + unpackCos[k] * orr - unpackSin[k] * oi;
+            im[k] = ei + unpackCos[k] * oi + unpackSin[k] * orr;
+            re[m] = er2 + unpackCos[m] * or2 - unpackSin[m] * oi2;
+            im[m] = ei2 + unpackCos[m] * oi2 + unpackSin[m] * or2;
+        }
+
+        re[0] = dcRe + dcIm;
+        im[0] = 0.0f;
+        re[half] = dcRe - dcIm;
+        im[half] = 0.0f;
+    }
+
+    /// <summary>
+    /// Shared plan for a size, built on first use. Call off the audio thread.
+    /// </summary>
+    /// <returns>Plan, nullptr if the size is not a power of two (>= 4)</returns>
+    static std::shared_ptr<const AudioFFT> getPlan(ma_uint32 fftSize) {
+        static std::mutex mutex;
+        static std::map<ma_uint32, std::shared_ptr<const AudioFFT>> plans;
+
+        if (!isPowerOfTwo(fftSize)) return nullptr;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& plan = plans[fftSize];
+        if (!plan) plan = std::make_shared<const AudioFFT>(fftSize);
+        return plan;
+    }
+};
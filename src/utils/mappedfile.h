@@ -0,0 +1,119 @@
+#pragma once
+#include "../include.h"
+
+#if defined(_WIN32)
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+// Read-only mapping of a whole file (mmap / MapViewOfFile).
+// - The file handle is closed once mapped: an open mapping costs address space, not a descriptor,
+//   so thousands of files can stay open at once.
+// - Access hints: adviseSequential() for playback read-ahead, prefetch() to fault a range in ahead
+//   of the reader (madvise WILLNEED). Both are no-ops where the platform has no equivalent.
+
+class MappedFile {
+private:
+    const ma_uint8* mapping = nullptr;
+    size_t mappedSize = 0;
+
+#if !defined(_WIN32)
+    static size_t getPageSize() {
+        static const size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+        return pageSize;
+    }
+#endif
+
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ma_result open(const std::string& path) {
+        close();
+
+#if defined(_WIN32)
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return MA_DOES_NOT_EXIST;
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+            CloseHandle(file);
+            return MA_INVALID_FILE;
+        }
+
+        HANDLE view = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (view == nullptr) return MA_ERROR;
+
+        mapping = (const ma_uint8*)MapViewOfFile(view, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(view); // the view keeps the mapping alive
+        if (mapping == nullptr) return MA_ERROR;
+        mappedSize = (size_t)size.QuadPart;
+#else
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return MA_DOES_NOT_EXIST;
+
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+            ::close(fd);
+            return MA_INVALID_FILE;
+        }
+
+        void* address = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd); // the mapping keeps the file alive
+        if (address == MAP_FAILED) return MA_ERROR;
+
+        mapping = (const ma_uint8*)address;
+        mappedSize = (size_t)info.st_size;
+#endif
+        return MA_SUCCESS;
+    }
+
+    void close() {
+        if (mapping == nullptr) return;
+#if defined(_WIN32)
+        UnmapViewOfFile(mapping);
+#else
+        munmap((void*)mapping, mappedSize);
+#endif
+        mapping = nullptr;
+        mappedSize = 0;
+    }
+
+    /// <summary>
+    /// Tells the kernel the file is read front to back, it reads ahead more aggressively.
+    /// </summary>
+    void adviseSequential() {
+#if !defined(_WIN32)
+        if (mapping) madvise((void*)mapping, mappedSize, MADV_SEQUENTIAL);
+#endif
+    }
+
+    /// <summary>
+    /// Starts reading [offset, offset + bytes) in the background so the reader does not fault on it.
+    /// </summary>
+    void prefetch(size_t offset, size_t bytes) {
+#if !defined(_WIN32)
+        if (mapping == nullptr || offset >= mappedSize) return;
+        bytes = std::min(bytes, mappedSize - offset);
+
+        // madvise wants a page aligned start
+        const size_t start = offset - offset % getPageSize();
+        madvise((void*)(mapping + start), bytes + (offset - start), MADV_WILLNEED);
+#else
+        (void)offset; (void)bytes;
+#endif
+    }
+
+    bool isOpen() const { return mapping != nullptr; }
+    const ma_uint8* data() const { return mapping; }
+    size_t size() const { return mappedSize; }
+};
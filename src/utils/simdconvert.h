@@ -0,0 +1,167 @@
+#pragma once
+#include "../include.h"
+#include "./simdmix.h"
+
+// Sample format and channel conversion kernels, same scaling as miniaudio without dithering.
+// Picked at compile time like the mixing kernels (AVX2 > SSE2 > scalar, SOUNDIO_NO_SIMD).
+
+// s16 -> f32, -32768..32767 to -1..0.99997
+static inline void convertS16ToF32Scalar(float* dst, const ma_int16* src, size_t samples) {
+    for (size_t i = 0; i < samples; i++)
+        dst[i] = (float)src[i] * (1.0f / 32768.0f);
+}
+
+// s32 -> f32
+static inline void convertS32ToF32Scalar(float* dst, const ma_int32* src, size_t samples) {
+    for (size_t i = 0; i < samples; i++)
+        dst[i] = (float)((double)src[i] / 2147483648.0);
+}
+
+// f32 -> s16, clipped to -1..1 then truncated
+static inline void convertF32ToS16Scalar(ma_int16* dst, const float* src, size_t samples) {
+    for (size_t i = 0; i < samples; i++) {
+        float x = std::min(1.0f, std::max(-1.0f, src[i]));
+        dst[i] = (ma_int16)(x * 32767.0f);
+    }
+}
+
+// f32 -> s32, clipped to -1..1 then truncated
+static inline void convertF32ToS32Scalar(ma_int32* dst, const float* src, size_t samples) {
+    for (size_t i = 0; i < samples; i++) {
+        double x = std::min(1.0, std::max(-1.0, (double)src[i]));
+        dst[i] = (ma_int32)(x * 2147483647.0);
+    }
+}
+
+// mono -> stereo, the sample is copied to both channels
+static inline void convertMonoToStereoF32Scalar(float* dst, const float* src, size_t frames) {
+    for (size_t i = 0; i < frames; i++)
+        dst[2 * i] = dst[2 * i + 1] = src[i];
+}
+
+// stereo -> mono, channels are averaged
+static inline void convertStereoToMonoF32Scalar(float* dst, const float* src, size_t frames) {
+    for (size_t i = 0; i < frames; i++)
+        dst[i] = (src[2 * i] + src[2 * i + 1]) * 0.5f;
+}
+
+static inline void convertS16ToF32(float* dst, const ma_int16* src, size_t samples) {
+    size_t i = 0;
+#if defined(SOUNDIO_SIMD_AVX2)
+    const __m256 scale = _mm256_set1_ps(1.0f / 32768.0f);
+    for (; i + 8 <= samples; i += 8) {
+        __m256i wide = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(src + i)));
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(wide), scale));
+    }
+#elif defined(SOUNDIO_SIMD_SSE2)
+    const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+    for (; i + 8 <= samples; i += 8) {
+        __m128i packed = _mm_loadu_si128((const __m128i*)(src + i));
+        // sign extend by placing each sample in the high half then shifting back
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(packed, packed), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(packed, packed), 16);
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+#endif
+    convertS16ToF32Scalar(dst + i, src + i, samples - i);
+}
+
+static inline void convertS32ToF32(float* dst, const ma_int32* src, size_t samples) {
+    size_t i = 0;
+#if defined(SOUNDIO_SIMD_AVX2)
+    const __m256 scale = _mm256_set1_ps(1.0f / 2147483648.0f);
+    for (; i + 8 <= samples; i += 8)
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)(src + i))), scale));
+#elif defined(SOUNDIO_SIMD_SSE2)
+    const __m128 scale = _mm_set1_ps(1.0f / 2147483648.0f);
+    for (; i + 4 <= samples; i += 4)
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)(src + i))), scale));
+#endif
+    convertS32ToF32Scalar(dst + i, src + i, samples - i);
+}
+
+static inline void convertF32ToS16(ma_int16* dst, const float* src, size_t samples) {
+    size_t i = 0;
+#if defined(SOUNDIO_SIMD_AVX2)
+    const __m256 lo = _mm256_set1_ps(-1.0f), hi = _mm256_set1_ps(1.0f), scale = _mm256_set1_ps(32767.0f);
+    for (; i + 16 <= samples; i += 16) {
+        __m256i a = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_min_ps(hi, _mm256_max_ps(lo, _mm256_loadu_ps(src + i))), scale));
+        __m256i b = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_min_ps(hi, _mm256_max_ps(lo, _mm256_loadu_ps(src + i + 8))), scale));
+        // packs works per 128-bit lane, restore the order afterwards
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xD8);
+        _mm256_storeu_si256((__m256i*)(dst + i), packed);
+    }
+#elif defined(SOUNDIO_SIMD_SSE2)
+    const __m128 lo = _mm_set1_ps(-1.0f), hi = _mm_set1_ps(1.0f), scale = _mm_set1_ps(32767.0f);
+    for (; i + 8 <= samples; i += 8) {
+        __m128i a = _mm_cvttps_epi32(_mm_mul_ps(_mm_min_ps(hi, _mm_max_ps(lo, _mm_loadu_ps(src + i))), scale));
+        __m128i b = _mm_cvttps_epi32(_mm_mul_ps(_mm_min_ps(hi, _mm_max_ps(lo, _mm_loadu_ps(src + i + 4))), scale));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi32(a, b));
+    }
+#endif
+    convertF32ToS16Scalar(dst + i, src + i, samples - i);
+}
+
+static inline void convertF32ToS32(ma_int32* dst, const float* src, size_t samples) {
+    size_t i = 0;
+    // 2147483647 is not representable in f32, the top is the largest float below 2^31
+#if defined(SOUNDIO_SIMD_AVX2)
+    const __m256 lo = _mm256_set1_ps(-2147483648.0f), hi = _mm256_set1_ps(2147483520.0f), scale = _mm256_set1_ps(2147483647.0f);
+    for (; i + 8 <= samples; i += 8) {
+        __m256 x = _mm256_min_ps(hi, _mm256_max_ps(lo, _mm256_mul_ps(_mm256_loadu_ps(src + i), scale)));
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_cvttps_epi32(x));
+    }
+#elif defined(SOUNDIO_SIMD_SSE2)
+    const __m128 lo = _mm_set1_ps(-2147483648.0f), hi = _mm_set1_ps(2147483520.0f), scale = _mm_set1_ps(2147483647.0f);
+    for (; i + 4 <= samples; i += 4) {
+        __m128 x = _mm_min_ps(hi, _mm_max_ps(lo, _mm_mul_ps(_mm_loadu_ps(src + i), scale)));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_cvttps_epi32(x));
+    }
+#endif
+    convertF32ToS32Scalar(dst + i, src + i, samples - i);
+}
+
+static inline void convertMonoToStereoF32(float* dst, const float* src, size_t frames) {
+    size_t i = 0;
+#if defined(SOUNDIO_SIMD_AVX2)
+    for (; i + 8 <= frames; i += 8) {
+        __m256 x = _mm256_loadu_ps(src + i);
+        __m256 a = _mm256_unpacklo_ps(x, x); // 0 0 1 1 | 4 4 5 5
+        __m256 b = _mm256_unpackhi_ps(x, x); // 2 2 3 3 | 6 6 7 7
+        _mm256_storeu_ps(dst + 2 * i, _mm256_permute2f128_ps(a, b, 0x20));
+        _mm256_storeu_ps(dst + 2 * i + 8, _mm256_permute2f128_ps(a, b, 0x31));
+    }
+#elif defined(SOUNDIO_SIMD_SSE2)
+    for (; i + 4 <= frames; i += 4) {
+        __m128 x = _mm_loadu_ps(src + i);
+        _mm_storeu_ps(dst + 2 * i, _mm_unpacklo_ps(x, x));
+        _mm_storeu_ps(dst + 2 * i + 4, _mm_unpackhi_ps(x, x));
+    }
+#endif
+    convertMonoToStereoF32Scalar(dst + 2 * i, src + i, frames - i);
+}
+
+static inline void convertStereoToMonoF32(float* dst, const float* src, size_t frames) {
+    size_t i = 0;
+#if defined(SOUNDIO_SIMD_AVX2)
+    const __m256 half = _mm256_set1_ps(0.5f);
+    for (; i + 8 <= frames; i += 8) {
+        __m256 a = _mm256_loadu_ps(src + 2 * i);     // L0 R0 L1 R1 | L2 R2 L3 R3
+        __m256 b = _mm256_loadu_ps(src + 2 * i + 8); // L4 R4 L5 R5 | L6 R6 L7 R7
+        __m256 sum = _mm256_hadd_ps(a, b);           // 0 1 4 5 | 2 3 6 7
+        sum = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(sum), 0xD8));
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(sum, half));
+    }
+#elif defined(SOUNDIO_SIMD_SSE2)
+    const __m128 half = _mm_set1_ps(0.5f);
+    for (; i + 4 <= frames; i += 4) {
+        __m128 a = _mm_loadu_ps(src + 2 * i);
+        __m128 b = _mm_loadu_ps(src + 2 * i + 4);
+        __m128 left = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 right = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_add_ps(left, right), half));
+    }
+#endif
+    convertStereoToMonoF32Scalar(dst + i, src + 2 * i, frames - i);
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include "../include.h"
+#include "./simdmix.h"
+
+// FIR kernels for the polyphase resampler, picked at compile time like the mixing kernels.
+// Taps and samples are contiguous f32, tap counts are multiples of 8 in practice.
+
+// sum of taps[i] * samples[i]
+static inline float dotF32Scalar(const float* taps, const float* samples, size_t count) {
+    float sum = 0.0f;
+    for (size_t i = 0; i < count; i++)
+        sum += taps[i] * samples[i];
+    return sum;
+}
+
+static inline float dotF32(const float* taps, const float* samples, size_t count) {
+    size_t i = 0;
+    float sum = 0.0f;
+#if defined(SOUNDIO_SIMD_AVX2)
+    // two accumulators hide the add latency
+    __m256 a = _mm256_setzero_ps(), b = _mm256_setzero_ps();
+    for (; i + 16 <= count; i += 16) {
+        a = _mm256_add_ps(a, _mm256_mul_ps(_mm256_loadu_ps(taps + i), _mm256_loadu_ps(samples + i)));
+        b = _mm256_add_ps(b, _mm256_mul_ps(_mm256_loadu_ps(taps + i + 8), _mm256_loadu_ps(samples + i + 8)));
+    }
+    for (; i + 8 <= count; i += 8)
+        a = _mm256_add_ps(a, _mm256_mul_ps(_mm256_loadu_ps(taps + i), _mm256_loadu_ps(samples + i)));
+    a = _mm256_add_ps(a, b);
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+    sum = _mm_cvtss_f32(s);
+#elif defined(SOUNDIO_SIMD_SSE2)
+    __m128 a = _mm_setzero_ps(), b = _mm_setzero_ps();
+    for (; i + 8 <= count; i += 8) {
+        a = _mm_add_ps(a, _mm_mul_ps(_mm_loadu_ps(taps + i), _mm_loadu_ps(samples + i)));
+        b = _mm_add_ps(b, _mm_mul_ps(_mm_loadu_ps(taps + i + 4), _mm_loadu_ps(samples + i + 4)));
+    }
+    a = _mm_add_ps(a, b);
+    a = _mm_add_ps(a, _mm_movehl_ps(a, a));
+    a = _mm_add_ss(a, _mm_shuffle_ps(a, a, 1));
+    sum = _mm_cvtss_f32(a);
+#endif
+    return sum + dotF32Scalar(taps + i, samples + i, count - i);
+}
@@ -0,0 +1,168 @@
+#pragma once
+#include "../include.h"
+
+// f32 mixing kernels, picked at compile time:
+// AVX2 (-mavx2, /arch:AVX2) > SSE2 (x86-64 baseline) > scalar.
+// Define SOUNDIO_NO_SIMD to force the scalar versions.
+
+#if !defined(SOUNDIO_NO_SIMD) && defined(__AVX2__)
+    #define SOUNDIO_SIMD_AVX2 1
+    #include <immintrin.h>
+#elif !defined(SOUNDIO_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+    #define SOUNDIO_SIMD_SSE2 1
+    #include <emmintrin.h>
+#endif
+
+static inline const char* getMixKernelName() {
+#if defined(SOUNDIO_SIMD_AVX2)
+    return "avx2";
+#elif defined(SOUNDIO_SIMD_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+// dst = src * gain
+static inline void mixScaleF32Scalar(float* dst, const float* src, float gain, size_t samples) {
+    for (size_t i = 0; i < samples; i++)
+        dst[i] = src[i] * gain;
+}
+
+// dst += src * gain
+static inline void mixAccumulateF32Scalar(float* dst, const float* src, float gain, size_t samples) {
+    for (size_t i = 0; i < samples; i++)
+        dst[i] += src[i] * gain;
+}
+
+// Soft clip knee at -6 dBFS: samples below it are left exactly as they are, above it the cubic
+// u - 4/27 u^3 (u in [0, 1.5]) bends the rest into +-1, reached at +-1.25
+static const float softClipKnee = 0.5f;
+
+static inline void softClipF32Scalar(float* buffer, size_t samples) {
+    for (size_t i = 0; i < samples; i++) {
+        const float a = std::fabs(buffer[i]);
+        const float u = std::min(1.5f, std::max(0.0f, a - softClipKnee) / (1.0f - softClipKnee));
+        const float y = std::min(a, softClipKnee) + (1.0f - softClipKnee) * (u - (4.0f / 27.0f) * u * u * u);
+        buffer[i] = std::copysign(y, buffer[i]);
+    }
+}
+
+// largest absolute sample
+static inline float peakF32Scalar(const float* buffer, size_t samples) {
+    float peak = 0.0f;
+    for (size_t i = 0; i < samples; i++)
+        peak = std::max(peak, std::fabs(buffer[i]));
+    return peak;
+}
+
+static inline void mixScaleF32(float* dst, const float* src, float gain, size_t samples) {
+    size_t i = 0;
+#if defined(SOUNDIO_SIMD_AVX2)
+    const __m256 g = _mm256_set1_ps(gain);
+    for (; i + 8 <= samples; i += 8)
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_loadu_ps(src + i), g));
+#elif defined(SOUNDIO_SIMD_SSE2)
+    const __m128 g = _mm_set1_ps(gain);
+    for (; i + 4 <= samples; i += 4)
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(src + i), g));
+#endif
+    mixScaleF32Scalar(dst + i, src + i, gain, samples - i);
+}
+
+static inline void mixAccumulateF32(float* dst, const float* src, float gain, size_t samples) {
+    size_t i = 0;
+#if defined(SOUNDIO_SIMD_AVX2)
+    const __m256 g = _mm256_set1_ps(gain);
+    for (; i + 16 <= samples; i += 16) {
+        __m256 a = _mm256_add_ps(_mm256_loadu_ps(dst + i), _mm256_mul_ps(_mm256_loadu_ps(src + i), g));
+        __m256 b = _mm256_add_ps(_mm256_loadu_ps(dst + i + 8), _mm256_mul_ps(_mm256_loadu_ps(src + i + 8), g));
+        _mm256_storeu_ps(dst + i, a);
+        _mm256_storeu_ps(dst + i + 8, b);
+    }
+    for (; i + 8 <= samples; i += 8)
+        _mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(dst + i), _mm256_mul_ps(_mm256_loadu_ps(src + i), g)));
+#elif defined(SOUNDIO_SIMD_SSE2)
+    const __m128 g = _mm_set1_ps(gain);
+    for (; i + 8 <= samples; i += 8) {
+        __m128 a = _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), g));
+        __m128 b = _mm_add_ps(_mm_loadu_ps(dst + i + 4), _mm_mul_ps(_mm_loadu_ps(src + i + 4), g));
+        _mm_storeu_ps(dst + i, a);
+        _mm_storeu_ps(dst + i + 4, b);
+    }
+    for (; i + 4 <= samples; i += 4)
+        _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), g)));
+#endif
+    mixAccumulateF32Scalar(dst + i, src + i, gain, samples - i);
+}
+
+static inline void softClipF32(float* buffer, size_t samples) {
+    size_t i = 0;
+#if defined(SOUNDIO_SIMD_AVX2)
+    // on magnitudes, the sign is put back last
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    const __m256 knee = _mm256_set1_ps(softClipKnee), range = _mm256_set1_ps(1.0f - softClipKnee);
+    const __m256 scale = _mm256_set1_ps(1.0f / (1.0f - softClipKnee)), top = _mm256_set1_ps(1.5f);
+    const __m256 k = _mm256_set1_ps(4.0f / 27.0f), zero = _mm256_setzero_ps();
+    for (; i + 8 <= samples; i += 8) {
+        const __m256 x = _mm256_loadu_ps(buffer + i);
+        const __m256 a = _mm256_and_ps(absMask, x);
+        const __m256 u = _mm256_min_ps(top, _mm256_mul_ps(_mm256_max_ps(zero, _mm256_sub_ps(a, knee)), scale));
+        const __m256 bend = _mm256_sub_ps(u, _mm256_mul_ps(k, _mm256_mul_ps(u, _mm256_mul_ps(u, u))));
+        const __m256 y = _mm256_add_ps(_mm256_min_ps(a, knee), _mm256_mul_ps(range, bend));
+        _mm256_storeu_ps(buffer + i, _mm256_or_ps(y, _mm256_andnot_ps(absMask, x)));
+    }
+#elif defined(SOUNDIO_SIMD_SSE2)
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    const __m128 knee = _mm_set1_ps(softClipKnee), range = _mm_set1_ps(1.0f - softClipKnee);
+    const __m128 scale = _mm_set1_ps(1.0f / (1.0f - softClipKnee)), top = _mm_set1_ps(1.5f);
+    const __m128 k = _mm_set1_ps(4.0f / 27.0f), zero = _mm_setzero_ps();
+    for (; i + 4 <= samples; i += 4) {
+        const __m128 x = _mm_loadu_ps(buffer + i);
+        const __m128 a = _mm_and_ps(absMask, x);
+        const __m128 u = _mm_min_ps(top, _mm_mul_ps(_mm_max_ps(zero, _mm_sub_ps(a, knee)), scale));
+        const __m128 bend = _mm_sub_ps(u, _mm_mul_ps(k, _mm_mul_ps(u, _mm_mul_ps(u, u))));
+        const __m128 y = _mm_add_ps(_mm_min_ps(a, knee), _mm_mul_ps(range, bend));
+        _mm_storeu_ps(buffer + i, _mm_or_ps(y, _mm_andnot_ps(absMask, x)));
+    }
+#endif
+    softClipF32Scalar(buffer + i, samples - i);
+}
+
+static inline float peakF32(const float* buffer, size_t samples) {
+    size_t i = 0;
+    float peak = 0.0f;
+#if defined(SOUNDIO_SIMD_AVX2)
+    const __m256 signMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    __m256 m = _mm256_setzero_ps();
+    for (; i + 8 <= samples; i += 8)
+        m = _mm256_max_ps(m, _mm256_and_ps(signMask, _mm256_loadu_ps(buffer + i)));
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, m);
+    for (float lane : lanes) peak = std::max(peak, lane);
+#elif defined(SOUNDIO_SIMD_SSE2)
+    const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    __m128 m = _mm_setzero_ps();
+    for (; i + 4 <= samples; i += 4)
+        m = _mm_max_ps(m, _mm_and_ps(signMask, _mm_loadu_ps(buffer + i)));
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, m);
+    for (float lane : lanes) peak = std::max(peak, lane);
+#endif
+    return std::max(peak, peakF32Scalar(buffer + i, samples - i));
+}
+
+// Interleaved frames, gain ramps linearly from startGain to endGain across the block
+static inline void gainRampF32(float* buffer, size_t frames, ma_uint32 channels, float startGain, float endGain) {
+    if (frames == 0) return;
+    if (startGain == endGain) {
+        mixScaleF32(buffer, buffer, startGain, frames * channels);
+        return;
+    }
+
+    const float step = (endGain - startGain) / (float)frames;
+    float gain = startGain;
+    for (size_t frame = 0; frame < frames; frame++, gain += step)
+        for (ma_uint32 ch = 0; ch < channels; ch++)
+            buffer[frame * channels + ch] *= gain;
+}
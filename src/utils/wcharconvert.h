@@ -14,8 +14,13 @@ static std::string convertWideCharToString(const wchar_t* wideString, size_t max
     result.resize(maxBufferSize);
 
     size_t converted = 0;
+#if defined(_WIN32)
     if (!wideString || wcstombs_s(&converted, &result[0], result.size(), wideString, _TRUNCATE) != 0)
         return ""; // conversion failed
+#else
+    converted = wcstombs(&result[0], wideString, result.size() - 1);
+    if (converted == (size_t)-1) return ""; // conversion failed
+#endif
 
     // trim back to actual size
     result.resize(converted);
@@ -0,0 +1,133 @@
+#pragma once
+#include "../include.h"
+
+// Work-stealing thread pool for coarse tasks (one file, one render job).
+// - Every worker owns a deque: it pops its own tasks from the front and, once empty,
+//   steals from the back of the others, so long tasks queued on one worker don't hold
+//   back the rest.
+// - Tasks get the index of the worker running them, to pick that worker's reusable buffers.
+// - Short mutex per deque, tasks are expected to run for milliseconds or more.
+
+class WorkStealingPool {
+public:
+    using Task = std::function<void(size_t worker)>;
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+
+    std::mutex waitMutex;
+    std::condition_variable wakeCondition; // workers, new tasks or stop
+    std::condition_variable idleCondition; // wait(), last task done
+    size_t pending = 0;                    // queued + running, under waitMutex
+    std::atomic<size_t> nextWorker{ 0 };
+    bool isStopping = false;
+
+    bool popOwn(size_t index, Task& task) {
+        Worker& worker = *workers[index];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (worker.tasks.empty()) return false;
+        task = std::move(worker.tasks.front());
+        worker.tasks.pop_front();
+        return true;
+    }
+
+    bool steal(size_t thief, Task& task) {
+        for (size_t offset = 1; offset < workers.size(); offset++) {
+            Worker& victim = *workers[(thief + offset) % workers.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (victim.tasks.empty()) continue;
+            task = std::move(victim.tasks.back());
+            victim.tasks.pop_back();
+            return true;
+        }
+        return false;
+    }
+
+    void run(size_t index) {
+        while (true) {
+            Task task;
+            if (popOwn(index, task) || steal(index, task)) {
+                task(index);
+
+                std::lock_guard<std::mutex> lock(waitMutex);
+                if (--pending == 0) idleCondition.notify_all();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(waitMutex);
+            if (isStopping) return;
+            // re-checked under the lock: a push always bumps pending before notifying
+            wakeCondition.wait(lock, [this] { return isStopping || hasQueuedTasks(); });
+        }
+    }
+
+    bool hasQueuedTasks() {
+        for (auto& worker : workers) {
+            std::lock_guard<std::mutex> lock(worker->mutex);
+            if (!worker->tasks.empty()) return true;
+        }
+        return false;
+    }
+
+public:
+    /// <summary>
+    /// Starts the workers, threadCount 0 uses one per hardware thread.
+    /// </summary>
+    explicit WorkStealingPool(size_t threadCount = 0) {
+        if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+        for (size_t i = 0; i < threadCount; i++)
+            workers.push_back(std::make_unique<Worker>());
+        for (size_t i = 0; i < threadCount; i++)
+            threads.emplace_back(&WorkStealingPool::run, this, i);
+    }
+
+    // Runs what is queued, then joins
+    ~WorkStealingPool() {
+        wait();
+        {
+            std::lock_guard<std::mutex> lock(waitMutex);
+            isStopping = true;
+        }
+        wakeCondition.notify_all();
+        for (auto& thread : threads) thread.join();
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    /// <summary>
+    /// Queues a task, spread round-robin over the workers' deques.
+    /// </summary>
+    void push(Task task) {
+        {
+            std::lock_guard<std::mutex> lock(waitMutex);
+            pending++;
+        }
+
+        Worker& worker = *workers[nextWorker.fetch_add(1) % workers.size()];
+        {
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            worker.tasks.push_back(std::move(task));
+        }
+
+        std::lock_guard<std::mutex> lock(waitMutex);
+        wakeCondition.notify_one();
+    }
+
+    /// <summary>
+    /// Blocks until every task pushed so far has run.
+    /// </summary>
+    void wait() {
+        std::unique_lock<std::mutex> lock(waitMutex);
+        idleCondition.wait(lock, [this] { return pending == 0; });
+    }
+
+    size_t getThreadCount() const { return threads.size(); }
+};